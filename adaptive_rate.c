@@ -0,0 +1,197 @@
+#include "adaptive_rate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alert_engine.h"
+#include "globals.h"
+#include "sensor_driver.h"
+
+static AdaptiveRate rates[NUMBER_OF_SENSORS];
+static uint32_t min_ms = 0;
+static uint32_t max_ms = 0;
+
+/**
+ * @brief Enables adaptive sampling with a range of sampling periods, or
+ * disables it. The statistics start over either way.
+ *
+ * Every sensor starts at the longest period and speeds up on activity. The
+ * shortest period is further limited per sensor by its conversion time.
+ *
+ * @param min_interval_ms The shortest sampling period, or 0 to sample every
+ * sensor once per sample_interval_ms.
+ * @param max_interval_ms The longest sampling period, at most
+ * ADAPTIVE_MAX_INTERVAL_MS.
+ *
+ * @return true if the setting was changed, false if the range is invalid.
+ */
+bool adaptive_configure(uint32_t min_interval_ms, uint32_t max_interval_ms) {
+  if (min_interval_ms != 0 && (max_interval_ms < min_interval_ms ||
+                               max_interval_ms > ADAPTIVE_MAX_INTERVAL_MS)) {
+    return false;
+  }
+  min_ms = min_interval_ms;
+  max_ms = min_interval_ms == 0 ? 0 : max_interval_ms;
+  absolute_time_t now = get_absolute_time();
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    rates[i] = (AdaptiveRate){.interval_ms = max_ms, .next_read = now};
+  }
+  return true;
+}
+
+/**
+ * @brief Returns whether sensors are sampled at adaptive rates.
+ *
+ * @return true if adaptive sampling is enabled.
+ */
+bool adaptive_is_enabled() { return min_ms != 0; }
+
+/**
+ * @brief Returns the sensors whose next read is due.
+ *
+ * @param now The current time.
+ * @param active_mask The bit mask of sampled sensors.
+ *
+ * @return The bit mask of the active sensors to read now.
+ */
+uint32_t adaptive_due_mask(absolute_time_t now, uint32_t active_mask) {
+  uint32_t due_mask = 0;
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if ((active_mask & (1u << i)) &&
+        absolute_time_diff_us(rates[i].next_read, now) >= 0) {
+      due_mask |= 1u << i;
+    }
+  }
+  return due_mask;
+}
+
+/**
+ * @brief Returns the shortest useful sampling period of a sensor: a faster
+ * read would return the same conversion again.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The period in milliseconds.
+ */
+static uint32_t floor_ms(const SensorConfig *sensor) {
+  const SensorDriver *driver = sensor_driver_of(sensor);
+  uint32_t conversion_ms = driver->conversion_ms(driver->resolution(sensor));
+  return conversion_ms > min_ms ? conversion_ms : min_ms;
+}
+
+/**
+ * @brief Returns whether a reading is within ADAPTIVE_NEAR_THRESHOLD_C of the
+ * warning or critical threshold of its sensor.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param value The register value.
+ *
+ * @return true if the reading is near a threshold.
+ */
+static bool is_near_threshold(uint8_t sensor, int16_t value) {
+  const AlertThresholds *t = alert_get_thresholds(sensor);
+  int32_t margin = ADAPTIVE_NEAR_THRESHOLD_C * 256;
+  return abs(value - t->warning) <= margin ||
+         abs(value - t->critical) <= margin;
+}
+
+/**
+ * @brief Adjusts the sampling period of every sensor that was just read.
+ *
+ * A sensor whose reading moved by ADAPTIVE_CHANGE_RAW or more, or is near an
+ * alert threshold, drops to its shortest period at once. A sensor that
+ * stays quiet for ADAPTIVE_STABLE_READS reads doubles its period, up to the
+ * longest one. A failed read keeps the period.
+ *
+ * @param sensors The sensors of the project.
+ * @param samples The samples returned by poll_sensors.
+ * @param len The number of sensors.
+ * @param polled_mask The bit mask of sensors that were read.
+ * @param valid_mask The bit mask of reads that succeeded.
+ * @param now The time of the sampling pass.
+ *
+ * @return None.
+ */
+void adaptive_update(const SensorConfig *sensors, const SensorSample *samples,
+                     size_t len, uint32_t polled_mask, uint32_t valid_mask,
+                     absolute_time_t now) {
+  for (size_t i = 0; i < len && i < NUMBER_OF_SENSORS; i++) {
+    if (!(polled_mask & (1u << i))) {
+      continue;
+    }
+    AdaptiveRate *rate = &rates[i];
+    rate->fixed_ms += rate->reads == 0 ? sample_interval_ms : rate->interval_ms;
+    rate->reads++;
+    if (valid_mask & (1u << i)) {
+      int16_t value = (int16_t)samples[i].raw;
+      bool has_changed = rate->has_value && abs(value - rate->last_value) >=
+                                                ADAPTIVE_CHANGE_RAW;
+      if (has_changed || is_near_threshold(i, value)) {
+        rate->interval_ms = 0;
+        rate->stable_reads = 0;
+      } else if (++rate->stable_reads >= ADAPTIVE_STABLE_READS) {
+        rate->interval_ms *= 2;
+        rate->stable_reads = 0;
+      }
+      rate->last_value = value;
+      rate->has_value = true;
+    }
+    uint32_t shortest_ms = floor_ms(&sensors[i]);
+    if (rate->interval_ms < shortest_ms) {
+      rate->interval_ms = shortest_ms;
+    } else if (rate->interval_ms > max_ms) {
+      rate->interval_ms = max_ms;
+    }
+    rate->next_read = delayed_by_ms(now, rate->interval_ms);
+  }
+}
+
+/**
+ * @brief Returns the time the next read of any active sensor is due.
+ *
+ * @param active_mask The bit mask of sampled sensors.
+ *
+ * @return The earliest deadline, or one sample_interval_ms from now if no
+ * sensor is active.
+ */
+absolute_time_t adaptive_next_deadline(uint32_t active_mask) {
+  absolute_time_t deadline = make_timeout_time_ms(sample_interval_ms);
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if ((active_mask & (1u << i)) &&
+        absolute_time_diff_us(rates[i].next_read, deadline) > 0) {
+      deadline = rates[i].next_read;
+    }
+  }
+  return deadline;
+}
+
+/**
+ * @brief Prints the sampling period of every sensor and the bus time saved
+ * against reading every sensor once per sample_interval_ms.
+ *
+ * The saving is the difference in reads, each costing the mean transfer
+ * time measured by poll_sensors. It is negative while sensors are sampled
+ * faster than the fixed rate.
+ *
+ * @return None.
+ */
+void print_adaptive_rates() {
+  printf("\nAdaptive sampling: ");
+  if (!adaptive_is_enabled()) {
+    printf("off, every sensor once per %lu ms\n",
+           (unsigned long)sample_interval_ms);
+    return;
+  }
+  printf("%lu to %lu ms\n", (unsigned long)min_ms, (unsigned long)max_ms);
+  int64_t saved_reads = 0;
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    int64_t fixed_reads = rates[i].fixed_ms / sample_interval_ms;
+    saved_reads += fixed_reads - rates[i].reads;
+    printf("Sensor %d: every %lu ms, %lu reads vs %lld fixed\n", i,
+           (unsigned long)rates[i].interval_ms, (unsigned long)rates[i].reads,
+           (long long)fixed_reads);
+  }
+  printf("Bus time saved: %.1f ms (%lld reads of %lu us)\n",
+         saved_reads * (float)sensor_poll_mean_read_us() / 1000.0f,
+         (long long)saved_reads, (unsigned long)sensor_poll_mean_read_us());
+}
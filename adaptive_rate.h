@@ -0,0 +1,37 @@
+#ifndef __ADAPTIVE_RATE_H__
+#define __ADAPTIVE_RATE_H__
+
+#include "config.h"
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+#include "sensor_poll.h"
+
+// Struct for storing the adaptive sampling state of one sensor
+// interval_ms the current sampling period
+// next_read the time the next read is due
+// last_value the register value of the previous read
+// has_value whether last_value holds a read
+// stable_reads the number of consecutive reads without activity
+// reads the number of reads since adaptive sampling was configured
+// fixed_ms the time those reads covered, which fixed-rate polling would
+// have spent sample_interval_ms per read on
+typedef struct {
+  uint32_t interval_ms;
+  absolute_time_t next_read;
+  int16_t last_value;
+  bool has_value;
+  uint8_t stable_reads;
+  uint32_t reads;
+  uint64_t fixed_ms;
+} AdaptiveRate;
+
+bool adaptive_configure(uint32_t min_interval_ms, uint32_t max_interval_ms);
+bool adaptive_is_enabled();
+uint32_t adaptive_due_mask(absolute_time_t now, uint32_t active_mask);
+void adaptive_update(const SensorConfig *sensors, const SensorSample *samples,
+                     size_t len, uint32_t polled_mask, uint32_t valid_mask,
+                     absolute_time_t now);
+absolute_time_t adaptive_next_deadline(uint32_t active_mask);
+void print_adaptive_rates();
+
+#endif
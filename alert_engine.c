@@ -0,0 +1,200 @@
+#include "alert_engine.h"
+
+#include <stdio.h>
+
+#include "event_queue.h"
+
+static const char *const level_names[] = {"normal", "warning", "critical"};
+
+static AlertThresholds thresholds[NUMBER_OF_SENSORS];
+// Per-sensor state is kept as separate arrays so the common case of every
+// sensor staying in its level is one tight pass of two compares per sensor.
+static int32_t band_low[NUMBER_OF_SENSORS];
+static int32_t band_high[NUMBER_OF_SENSORS];
+static uint8_t levels[NUMBER_OF_SENSORS];
+static uint8_t pending_levels[NUMBER_OF_SENSORS];
+static uint8_t pending_counts[NUMBER_OF_SENSORS];
+static volatile uint8_t highest_level = ALERT_NORMAL;
+
+/**
+ * @brief Recomputes the range of values that keeps a sensor in its level.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ *
+ * @return None.
+ */
+static void update_band(uint sensor) {
+  const AlertThresholds *t = &thresholds[sensor];
+  if (levels[sensor] == ALERT_NORMAL) {
+    band_low[sensor] = INT32_MIN;
+    band_high[sensor] = t->warning;
+  } else if (levels[sensor] == ALERT_WARNING) {
+    band_low[sensor] = t->warning - t->hysteresis;
+    band_high[sensor] = t->critical;
+  } else {
+    band_low[sensor] = t->critical - t->hysteresis;
+    band_high[sensor] = INT32_MAX;
+  }
+}
+
+/**
+ * @brief Sets every sensor to the default thresholds and the normal level.
+ *
+ * @return None.
+ */
+void alert_engine_init() {
+  AlertThresholds defaults = {.warning = ALERT_DEFAULT_WARNING_C * 256,
+                              .critical = ALERT_DEFAULT_CRITICAL_C * 256,
+                              .hysteresis = ALERT_DEFAULT_HYSTERESIS_C * 256,
+                              .debounce = ALERT_DEFAULT_DEBOUNCE};
+  for (uint8_t i = 0; i < NUMBER_OF_SENSORS; i++) {
+    alert_set_thresholds(i, &defaults);
+  }
+}
+
+/**
+ * @brief Sets the thresholds of a sensor and returns it to the normal level.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param new_thresholds A pointer to the thresholds.
+ *
+ * @return true if the thresholds were set, false if the warning threshold is
+ * above the critical one, the hysteresis is negative or the debounce count
+ * is 0.
+ */
+bool alert_set_thresholds(uint8_t sensor,
+                          const AlertThresholds *new_thresholds) {
+  if (sensor >= NUMBER_OF_SENSORS ||
+      new_thresholds->warning > new_thresholds->critical ||
+      new_thresholds->hysteresis < 0 || new_thresholds->debounce == 0) {
+    return false;
+  }
+  thresholds[sensor] = *new_thresholds;
+  levels[sensor] = ALERT_NORMAL;
+  pending_counts[sensor] = 0;
+  update_band(sensor);
+  return true;
+}
+
+/**
+ * @brief Returns the thresholds of a sensor.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ *
+ * @return A pointer to the thresholds, or NULL if the index is out of range.
+ */
+const AlertThresholds *alert_get_thresholds(uint8_t sensor) {
+  return sensor < NUMBER_OF_SENSORS ? &thresholds[sensor] : NULL;
+}
+
+/**
+ * @brief Moves a sensor towards the level of a value that left its band.
+ *
+ * A value enters a higher level as soon as it reaches the level's threshold,
+ * and only leaves it once it falls the hysteresis below that threshold. The
+ * new level must then be seen for the debounce count of consecutive samples
+ * before it is taken and an event is emitted.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param value The register value.
+ * @param timestamp_ms The time of the sample.
+ *
+ * @return None.
+ */
+static void step_level(uint sensor, int16_t value, uint32_t timestamp_ms) {
+  const AlertThresholds *t = &thresholds[sensor];
+  uint8_t level = levels[sensor];
+  uint8_t up = value >= t->critical  ? ALERT_CRITICAL
+               : value >= t->warning ? ALERT_WARNING
+                                     : ALERT_NORMAL;
+  uint8_t held = value >= t->critical - t->hysteresis  ? ALERT_CRITICAL
+                 : value >= t->warning - t->hysteresis ? ALERT_WARNING
+                                                       : ALERT_NORMAL;
+  uint8_t target = up > level ? up : (held < level ? held : level);
+
+  if (target == level) {
+    pending_counts[sensor] = 0;
+    return;
+  }
+  if (pending_counts[sensor] == 0 || pending_levels[sensor] != target) {
+    pending_levels[sensor] = target;
+    pending_counts[sensor] = 0;
+  }
+  if (++pending_counts[sensor] < t->debounce) {
+    return;
+  }
+
+  levels[sensor] = target;
+  pending_counts[sensor] = 0;
+  update_band(sensor);
+  event_push(EVENT_ALERT_NORMAL + target, sensor, timestamp_ms, value);
+}
+
+/**
+ * @brief Evaluates the thresholds of every sensor against its latest sample.
+ *
+ * The filtered value of each sample is checked against the band of its
+ * sensor's level in one pass over all sensors. Only sensors whose value
+ * left the band, or that are debouncing a level change, take the slower
+ * path. It must be called from the sampling core only.
+ *
+ * @param samples The latest sample of every sensor.
+ * @param len The number of samples.
+ * @param valid_mask The bit mask of samples that hold a new reading.
+ *
+ * @return None.
+ */
+void alert_evaluate(const SensorSample *samples, size_t len,
+                    uint32_t valid_mask) {
+  uint32_t changed_mask = 0;
+  if (len > NUMBER_OF_SENSORS) {
+    len = NUMBER_OF_SENSORS;
+  }
+
+  for (uint i = 0; i < len; i++) {
+    int32_t value = samples[i].filtered;
+    bool is_outside = value < band_low[i] || value >= band_high[i] ||
+                      pending_counts[i] != 0;
+    changed_mask |= (uint32_t)is_outside << i;
+  }
+  changed_mask &= valid_mask;
+
+  while (changed_mask != 0) {
+    uint i = __builtin_ctz(changed_mask);
+    changed_mask &= changed_mask - 1;
+    step_level(i, samples[i].filtered,
+               to_ms_since_boot(samples[i].timestamp));
+  }
+
+  uint8_t highest = ALERT_NORMAL;
+  for (uint i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if (levels[i] > highest) {
+      highest = levels[i];
+    }
+  }
+  highest_level = highest;
+}
+
+/**
+ * @brief Returns the highest alert level of all sensors.
+ *
+ * This is safe to call from either core.
+ *
+ * @return One of ALERT_LEVELS.
+ */
+uint8_t alert_highest_level() { return highest_level; }
+
+/**
+ * @brief Prints the thresholds and alert level of every sensor.
+ *
+ * @return None.
+ */
+void print_alert_levels() {
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const AlertThresholds *t = &thresholds[i];
+    printf("Sensor %d: %s (warning %.2f C, critical %.2f C, hyst %.2f C, "
+           "debounce %u)\n",
+           i, level_names[levels[i]], t->warning / 256.0f,
+           t->critical / 256.0f, t->hysteresis / 256.0f, t->debounce);
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef __ALERT_ENGINE_H__
+#define __ALERT_ENGINE_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+#include "sensor_poll.h"
+
+enum ALERT_LEVELS {
+  ALERT_NORMAL,
+  ALERT_WARNING,
+  ALERT_CRITICAL,
+};
+
+// Struct for storing the alert thresholds of one sensor, in register units
+// (1/256 C)
+// warning the value at or above which the sensor is in warning
+// critical the value at or above which the sensor is critical
+// hysteresis how far below a threshold the value must fall to leave its level
+// debounce the number of consecutive samples a new level must be seen for
+typedef struct {
+  int16_t warning;
+  int16_t critical;
+  int16_t hysteresis;
+  uint8_t debounce;
+} AlertThresholds;
+
+void alert_engine_init();
+bool alert_set_thresholds(uint8_t sensor, const AlertThresholds *thresholds);
+const AlertThresholds *alert_get_thresholds(uint8_t sensor);
+void alert_evaluate(const SensorSample *samples, size_t len,
+                    uint32_t valid_mask);
+uint8_t alert_highest_level();
+void print_alert_levels();
+
+#endif
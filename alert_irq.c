@@ -0,0 +1,138 @@
+#include "alert_irq.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "event_queue.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "sensor_poll.h"
+
+static volatile bool is_active_high = false;
+static volatile bool is_pending = false;
+static uint64_t edge_us;
+static AlertIrqStats alert_irq_stats = {0};
+
+/**
+ * @brief Sets which ALERT edge is treated as an assertion.
+ *
+ * @param active_high true if the sensors drive ALERT high when asserted,
+ * matching ALERT_POLARITY_MASK in their config register.
+ *
+ * @return None.
+ */
+void alert_irq_set_polarity(bool active_high) { is_active_high = active_high; }
+
+/**
+ * @brief Returns which ALERT level is treated as asserted.
+ *
+ * @return true if ALERT is asserted high.
+ */
+bool alert_irq_is_active_high() { return is_active_high; }
+
+/**
+ * @brief Records an ALERT edge from the GPIO interrupt handler.
+ *
+ * Only the asserting edge is recorded; the releasing edge that follows the
+ * deferred read is ignored. The handler itself does no bus access, it only
+ * timestamps the edge and marks a read as pending, so it is safe against
+ * transfers in progress on the sampling core. Edges that arrive before the
+ * pending read starts are coalesced into it; an edge during the read makes
+ * another read pending.
+ *
+ * @param events The GPIO_IRQ_EDGE_* events of the interrupt.
+ *
+ * @return None.
+ */
+void HOT_PATH_FUNC(alert_irq_edge)(uint32_t events) {
+  uint32_t asserting = is_active_high ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if (!(events & asserting)) {
+    return;
+  }
+  alert_irq_stats.edges++;
+  if (is_pending) {
+    alert_irq_stats.coalesced++;
+    return;
+  }
+  edge_us = to_us_since_boot(get_absolute_time());
+  is_pending = true;
+}
+
+/**
+ * @brief Returns whether an ALERT edge is waiting for its deferred read.
+ *
+ * @return true if alert_irq_service has work to do.
+ */
+bool alert_irq_pending() { return is_pending; }
+
+/**
+ * @brief Performs the deferred read of a pending ALERT edge.
+ *
+ * In interrupt mode every TCN75A holds ALERT asserted until one of its
+ * registers is read, and since the line is a wired-OR the asserting sensor
+ * is unknown. This function therefore reads the ambient register of every
+ * active sensor through poll_sensors, which overlaps the hardware buses,
+ * and publishes each value as an EVENT_ALERT_CAPTURE event stamped with the
+ * time of its read. The edge-to-capture latency is recorded per edge. It
+ * must be called from the sampling core, outside of interrupt context.
+ *
+ * @param sensors The sensors of the project.
+ * @param len The number of sensors.
+ * @param active_mask The bit mask of sensors to read.
+ *
+ * @return None.
+ */
+void alert_irq_service(const SensorConfig *sensors, size_t len,
+                       uint32_t active_mask) {
+  static SensorSample captures[NUMBER_OF_SENSORS];
+  if (!is_pending) {
+    return;
+  }
+  if (len > NUMBER_OF_SENSORS) {
+    len = NUMBER_OF_SENSORS;
+  }
+
+  // Claim the edge before reading, so an edge that arrives during the read
+  // is serviced by another read rather than lost. In interrupt mode a lost
+  // edge would leave ALERT latched with no further edges.
+  uint32_t irq_state = save_and_disable_interrupts();
+  uint64_t claimed_us = edge_us;
+  is_pending = false;
+  restore_interrupts(irq_state);
+
+  poll_sensors(sensors, len, active_mask, captures);
+  uint32_t latency_us =
+      (uint32_t)(to_us_since_boot(get_absolute_time()) - claimed_us);
+
+  for (size_t i = 0; i < len; i++) {
+    if ((active_mask & (1u << i)) && captures[i].status == 2) {
+      event_push(EVENT_ALERT_CAPTURE, i,
+                 to_ms_since_boot(captures[i].timestamp),
+                 (int16_t)captures[i].raw);
+    }
+  }
+  alert_irq_stats.captures++;
+  alert_irq_stats.last_latency_us = latency_us;
+  alert_irq_stats.total_latency_us += latency_us;
+  if (latency_us > alert_irq_stats.max_latency_us) {
+    alert_irq_stats.max_latency_us = latency_us;
+  }
+}
+
+/**
+ * @brief Prints the ALERT interrupt statistics to the console.
+ *
+ * @return None.
+ */
+void print_alert_irq_stats() {
+  const AlertIrqStats *s = &alert_irq_stats;
+  printf("ALERT: %lu edges, %lu captures, %lu coalesced\n",
+         (unsigned long)s->edges, (unsigned long)s->captures,
+         (unsigned long)s->coalesced);
+  if (s->captures != 0) {
+    printf("ALERT edge-to-capture: last %lu us, mean %lu us, max %lu us\n",
+           (unsigned long)s->last_latency_us,
+           (unsigned long)(s->total_latency_us / s->captures),
+           (unsigned long)s->max_latency_us);
+  }
+}
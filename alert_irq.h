@@ -0,0 +1,31 @@
+#ifndef __ALERT_IRQ_H__
+#define __ALERT_IRQ_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing ALERT interrupt statistics
+// edges the number of asserting ALERT edges seen by the interrupt handler
+// captures the number of deferred reads that completed
+// coalesced the number of edges that arrived while a read was still pending
+// last_latency_us the time from the last edge to its captured value
+// max_latency_us the longest time from an edge to its captured value
+// total_latency_us the sum of all edge-to-capture times
+typedef struct {
+  uint32_t edges;
+  uint32_t captures;
+  uint32_t coalesced;
+  uint32_t last_latency_us;
+  uint32_t max_latency_us;
+  uint64_t total_latency_us;
+} AlertIrqStats;
+
+void alert_irq_set_polarity(bool active_high);
+bool alert_irq_is_active_high();
+void alert_irq_edge(uint32_t events);
+bool alert_irq_pending();
+void alert_irq_service(const SensorConfig *sensors, size_t len,
+                       uint32_t active_mask);
+void print_alert_irq_stats();
+
+#endif
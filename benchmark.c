@@ -0,0 +1,342 @@
+#include "benchmark.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "console.h"
+#include "filter.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "hardware/sync.h"
+#include "i2c_util.h"
+#include "pio_i2c.h"
+#include "sample_codec.h"
+#include "sensor_driver.h"
+#include "sensor_poll.h"
+
+extern void gpio_callback(uint gpio, uint32_t events);
+
+// Section bounds from the SDK linker script. Code placed in SRAM is copied
+// from flash together with .data, so it is counted there.
+extern char __data_start__[], __data_end__[];
+extern char __bss_start__[], __bss_end__[];
+
+/**
+ * @brief Prints one row of a benchmark table.
+ *
+ * @param name The name of the measured path.
+ * @param total_us The total time of all iterations.
+ * @param max_us The longest single iteration.
+ * @param cpu_us The total time the CPU spent outside of FIFO waits.
+ * @param bytes The number of payload bytes transferred per iteration.
+ *
+ * @return None.
+ */
+static void print_bench_row(const char *name, uint64_t total_us,
+                            uint32_t max_us, uint64_t cpu_us, uint bytes) {
+  float mean_us = (float)total_us / BENCH_ITERATIONS;
+  printf("| %-10s | %8.1f | %8lu | %9.0f | %8.1f |\n", name, mean_us,
+         (unsigned long)max_us, bytes * 1000000.0f / mean_us,
+         (float)cpu_us / BENCH_ITERATIONS);
+}
+
+/**
+ * @brief Reads the temperature register of a sensor on a hardware I2C
+ * instance BENCH_ITERATIONS times and prints one benchmark row.
+ *
+ * The read is driven through reg_read_start/reg_read_poll so that, like the
+ * PIO path, time spent spinning on the FIFO can be separated from the time
+ * the CPU does useful work.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param name The name of the row.
+ *
+ * @return None.
+ */
+static void bench_hw_sensor(const SensorConfig *sensor, const char *name) {
+  uint8_t reg = sensor_driver_of(sensor)->temp_reg;
+  uint8_t buf[2];
+  uint64_t total_us = 0;
+  uint64_t wait_us = 0;
+  uint32_t max_us = 0;
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    absolute_time_t start = get_absolute_time();
+    if (reg_read_start(sensor->i2c_inst, sensor->addr, reg, sizeof(buf)) < 0) {
+      printf("| %-10s | read could not be queued\n", name);
+      return;
+    }
+    absolute_time_t wait_start = get_absolute_time();
+    while (reg_read_poll(sensor->i2c_inst, buf, sizeof(buf)) == 0 &&
+           absolute_time_diff_us(start, get_absolute_time()) <
+               I2C_XFER_TIMEOUT_MICRO_SEC) {
+    }
+    absolute_time_t end = get_absolute_time();
+    uint32_t elapsed_us = (uint32_t)absolute_time_diff_us(start, end);
+    wait_us += absolute_time_diff_us(wait_start, end);
+    total_us += elapsed_us;
+    if (elapsed_us > max_us) {
+      max_us = elapsed_us;
+    }
+  }
+  print_bench_row(name, total_us, max_us, total_us - wait_us, sizeof(buf));
+}
+
+/**
+ * @brief Reads the temperature register of a sensor on a PIO I2C bus
+ * BENCH_ITERATIONS times and prints one benchmark row.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param name The name of the row.
+ *
+ * @return None.
+ */
+static void bench_pio_sensor(const SensorConfig *sensor, const char *name) {
+  uint8_t reg = sensor_driver_of(sensor)->temp_reg;
+  uint8_t buf[2];
+  uint64_t total_us = 0;
+  uint32_t max_us = 0;
+
+  uint64_t wait_start = pio_i2c_wait_us();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    absolute_time_t start = get_absolute_time();
+    pio_i2c_reg_read(sensor->pio_bus, sensor->addr, reg, buf, sizeof(buf));
+    uint32_t elapsed_us =
+        (uint32_t)absolute_time_diff_us(start, get_absolute_time());
+    total_us += elapsed_us;
+    if (elapsed_us > max_us) {
+      max_us = elapsed_us;
+    }
+  }
+  uint64_t wait_us = pio_i2c_wait_us() - wait_start;
+  print_bench_row(name, total_us, max_us, total_us - wait_us, sizeof(buf));
+}
+
+/**
+ * @brief Compares the hardware I2C controller against the PIO I2C master.
+ *
+ * This function reads the temperature register of every configured sensor
+ * BENCH_ITERATIONS times over the bus it is wired to, and prints the mean
+ * and worst-case latency per read, the payload throughput, and the CPU time
+ * per read. Each row is named after the path and the proj_sensors index.
+ *
+ * @return None.
+ */
+void benchmark_i2c_paths() {
+  char name[12];
+
+  printf("I2C read benchmark (%d reads of 2 bytes per sensor)\n",
+         BENCH_ITERATIONS);
+  printf("| %-10s | %8s | %8s | %9s | %8s |\n", "Path", "us/read", "max us",
+         "bytes/s", "cpu us");
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const SensorConfig *sensor = &proj_sensors[i];
+    if (sensor->i2c_inst != NULL) {
+      snprintf(name, sizeof(name), "hw i2c %d", i);
+      bench_hw_sensor(sensor, name);
+    } else if (sensor->pio_bus != NULL) {
+      snprintf(name, sizeof(name), "pio i2c %d", i);
+      bench_pio_sensor(sensor, name);
+    }
+  }
+}
+
+/**
+ * @brief Measures the size and encode cost of the compressed sample format.
+ *
+ * This function encodes BENCH_ITERATIONS synthetic samples that resemble an
+ * indoor sensor at 12-bit resolution: one sample every SAMPLE_INTERVAL_MS
+ * with occasional jitter, and a value that wanders by one LSB every few
+ * dozen samples with one LSB of conversion noise on top, as a real sensor
+ * reads. It prints the compression ratio against the 2-byte register value
+ * alone and the cost of sample_encode in clk_sys cycles per sample.
+ *
+ * @return None.
+ */
+void benchmark_sample_codec() {
+  static uint32_t timestamps[BENCH_ITERATIONS];
+  static uint16_t values[BENCH_ITERATIONS];
+  uint8_t out[SAMPLE_CODEC_MAX_BYTES];
+  uint32_t seed = 1;
+  uint32_t ts = 0;
+  int16_t raw = 22 * 256;
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    seed = seed * 1664525 + 1013904223;
+    if ((seed >> 24) < 8) {
+      raw += (seed & (1 << 16)) ? 16 : -16;
+    }
+    ts += SAMPLE_INTERVAL_MS + ((seed >> 8 & 0xFF) == 0 ? 1 : 0);
+    timestamps[i] = ts;
+    // The noise is 0 half the time and one LSB either way otherwise.
+    int16_t noise = (seed & (1 << 4)) ? 0 : (seed & (1 << 5)) ? 16 : -16;
+    values[i] = (uint16_t)(raw + noise);
+  }
+
+  SampleEncoder enc;
+  size_t bytes = 0;
+  sample_encoder_init(&enc);
+  absolute_time_t start = get_absolute_time();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    bytes += sample_encode(&enc, timestamps[i], values[i], out);
+  }
+  bytes += sample_encoder_flush(&enc, out);
+  uint64_t elapsed_us = absolute_time_diff_us(start, get_absolute_time());
+
+  float cycles = (float)elapsed_us * (clock_get_hz(clk_sys) / 1000000) /
+                 BENCH_ITERATIONS;
+  printf("Sample codec (%d samples): %u bytes, %.3f bytes/sample, "
+         "%.1fx vs raw, %.0f cycles/sample\n",
+         BENCH_ITERATIONS, (unsigned)bytes, (float)bytes / BENCH_ITERATIONS,
+         2.0f * BENCH_ITERATIONS / bytes, cycles);
+}
+
+/**
+ * @brief Measures the cost of every filter at its largest window.
+ *
+ * This function runs BENCH_ITERATIONS samples with one-LSB jitter through
+ * each filter of sensor 0 and prints the mean cost in clk_sys cycles against
+ * FILTER_CYCLE_BUDGET. Sensor 0 is left without a filter afterwards.
+ *
+ * @return None.
+ */
+void benchmark_filters() {
+  static const uint8_t types[] = {FILTER_EMA, FILTER_BOXCAR, FILTER_MEDIAN};
+  static const uint8_t params[] = {FILTER_MAX_EMA_SHIFT, FILTER_MAX_WINDOW,
+                                   (FILTER_MAX_WINDOW - 1) | 1};
+  static const char *const names[] = {"ema", "boxcar", "median"};
+  uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+  volatile int16_t sink;
+
+  printf("Filter benchmark (%d samples, budget %d cycles)\n",
+         BENCH_ITERATIONS, FILTER_CYCLE_BUDGET);
+  for (uint t = 0; t < sizeof(types); t++) {
+    filter_configure(0, types[t], params[t]);
+    absolute_time_t start = get_absolute_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+      sink = filter_sample(0, 22 * 256 + ((i * 7) % 3 - 1) * 16);
+    }
+    uint64_t elapsed_us = absolute_time_diff_us(start, get_absolute_time());
+    float cycles = (float)elapsed_us * cycles_per_us / BENCH_ITERATIONS;
+    printf("| %-6s (%u) | %6.0f cycles | %s |\n", names[t], params[t], cycles,
+           cycles <= FILTER_CYCLE_BUDGET ? "ok" : "OVER BUDGET");
+  }
+  (void)sink;
+  filter_configure(0, FILTER_NONE, 0);
+}
+
+/**
+ * @brief Runs the button branch of the GPIO interrupt handler. Both edges at
+ * once only reset the debounce state of BTN4, so no action is triggered.
+ *
+ * @return None.
+ */
+static void isr_path() {
+  gpio_callback(BTN4, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+}
+
+/**
+ * @brief Polls and filters every sensor like the sampling task does.
+ *
+ * @return None.
+ */
+static void sample_path() {
+  static SensorSample bench_samples[NUMBER_OF_SENSORS];
+  poll_sensors(proj_sensors, NUMBER_OF_SENSORS, ALL_SENSORS_MASK,
+               bench_samples);
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    bench_samples[i].filtered = filter_sample(i, (int16_t)bench_samples[i].raw);
+  }
+}
+
+/**
+ * @brief Counts the clk_sys cycles of one call with interrupts disabled.
+ *
+ * @param path The function to measure.
+ * @param is_cold true to flush the XIP cache first, so every instruction
+ * fetched from flash misses.
+ *
+ * @return The number of cycles, up to the 24-bit range of SysTick.
+ */
+static uint32_t time_path(void (*path)(), bool is_cold) {
+  uint32_t status = save_and_disable_interrupts();
+  if (is_cold) {
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush;
+  }
+  systick_hw->cvr = 0;
+  uint32_t start = systick_hw->cvr;
+  path();
+  uint32_t cycles = (start - systick_hw->cvr) & 0xFFFFFF;
+  restore_interrupts(status);
+  return cycles;
+}
+
+/**
+ * @brief Measures the stalls that XIP cache misses add to the interrupt
+ * handler and the sampling path, and the SRAM used by the build.
+ *
+ * Each path is run BENCH_XIP_RUNS times with a warm cache and with the XIP
+ * cache flushed beforehand, which is the worst case after a menu or the log
+ * export evicted it. The difference is the stall that RAM_HOT_PATH removes
+ * for the code it moves; SDK functions the paths call stay in flash either
+ * way. Run it on a build with and without RAM_HOT_PATH to compare, and
+ * compare the .data sizes for the SRAM cost.
+ *
+ * @return None.
+ */
+void benchmark_xip() {
+  static void (*const paths[])() = {isr_path, sample_path};
+  static const char *const names[] = {"isr", "sample"};
+  systick_hw->rvr = 0xFFFFFF;
+  systick_hw->csr =
+      M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+#ifdef RAM_HOT_PATH
+  const char *placement = "SRAM";
+#else
+  const char *placement = "flash";
+#endif
+  printf("XIP benchmark (%d runs, hot path in %s)\n", BENCH_XIP_RUNS,
+         placement);
+  printf("| %-6s | %10s | %10s | %10s |\n", "Path", "warm cyc", "cold max",
+         "stall cyc");
+  for (uint p = 0; p < count_of(paths); p++) {
+    uint64_t warm_total = 0;
+    uint32_t cold_max = 0;
+    for (int i = 0; i < BENCH_XIP_RUNS; i++) {
+      time_path(paths[p], false);
+      warm_total += time_path(paths[p], false);
+      uint32_t cold = time_path(paths[p], true);
+      if (cold > cold_max) {
+        cold_max = cold;
+      }
+    }
+    uint32_t warm = (uint32_t)(warm_total / BENCH_XIP_RUNS);
+    printf("| %-6s | %10lu | %10lu | %10ld |\n", names[p],
+           (unsigned long)warm, (unsigned long)cold_max,
+           (long)cold_max - (long)warm);
+  }
+  printf("SRAM: .data %u bytes (includes code run from SRAM), .bss %u "
+         "bytes\n",
+         (unsigned)(__data_end__ - __data_start__),
+         (unsigned)(__bss_end__ - __bss_start__));
+}
+
+/**
+ * @brief Runs every benchmark and prints the results to the console. The
+ * event loop is not running yet, so the console is drained after each one.
+ *
+ * @return None.
+ */
+void run_benchmarks() {
+  benchmark_i2c_paths();
+  console_flush(CONSOLE_FLUSH_TIMEOUT_US);
+  benchmark_sample_codec();
+  console_flush(CONSOLE_FLUSH_TIMEOUT_US);
+  benchmark_filters();
+  console_flush(CONSOLE_FLUSH_TIMEOUT_US);
+  benchmark_xip();
+  console_flush(CONSOLE_FLUSH_TIMEOUT_US);
+}
@@ -0,0 +1,12 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "pico/stdlib.h"
+
+void benchmark_i2c_paths();
+void benchmark_sample_codec();
+void benchmark_filters();
+void benchmark_xip();
+void run_benchmarks();
+
+#endif
@@ -9,10 +9,29 @@ const GpioConfig proj_gpio[NUMBER_OF_GPIOS] = {
     {BTN2, GPIO_IN, true, false},    {BTN3, GPIO_IN, true, false},
     {BTN4, GPIO_IN, true, false},    {LED0, GPIO_OUT, false, false},
     {LED1, GPIO_OUT, false, false},  {ONBOARD_LED, GPIO_OUT, false, false},
-    {ALERT_GP, GPIO_IN, false, true}};
+    {ALERT_GP, GPIO_IN, true, true}};
 
 // Define an array of I2CConfig structures that define the configuration for
 // each I2C device used by the program.
-const I2CConfig proj_i2c[NUMBER_OF_I2C] = {{.sda_pin_number = I2C_SDA_PIN,
+const I2CConfig proj_i2c[NUMBER_OF_I2C] = {{.i2c_inst = i2c0,
+                                            .sda_pin_number = I2C_SDA_PIN,
                                             .scl_pin_number = I2C_SCL_PIN,
+                                            .has_pullup = true},
+                                           {.i2c_inst = i2c1,
+                                            .sda_pin_number = I2C1_SDA_PIN,
+                                            .scl_pin_number = I2C1_SCL_PIN,
                                             .has_pullup = true}};
+
+// Define the PIO I2C bus used for sensors beyond the hardware controllers.
+// SCL is always the pin after SDA.
+PioI2C proj_pio_i2c = {.pio = pio0,
+                       .sda_pin_number = PIO_I2C_SDA_PIN,
+                       .baudrate = PIO_I2C_BAUDRATE};
+
+// Define an array of SensorConfig structures that define which bus and address
+// each polled temperature sensor lives on. The part at each address is
+// detected at boot and treated as a TCN75A until then.
+SensorConfig proj_sensors[NUMBER_OF_SENSORS] = {
+    {.i2c_inst = i2c0, .addr = TCN75A_DEFAULT_ADDR},
+    {.i2c_inst = i2c1, .addr = TCN75A_DEFAULT_ADDR},
+    {.pio_bus = &proj_pio_i2c, .addr = TCN75A_DEFAULT_ADDR}};
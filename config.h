@@ -4,8 +4,10 @@
 
 // Include header files for various functions and macros used by the program.
 #include "gpio_util.h"
+#include "hardware/flash.h"
 #include "hardware/i2c.h"
 #include "i2c_util.h"
+#include "pio_i2c.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 
@@ -22,46 +24,164 @@
 #define ALERT_GP 18
 #define I2C_SDA_PIN 16
 #define I2C_SCL_PIN 17
+#define I2C1_SDA_PIN 2
+#define I2C1_SCL_PIN 3
+#define PIO_I2C_SDA_PIN 20
+#define PIO_I2C_SCL_PIN 21
 #define I2C_READ_TIMEOUT_MICRO_SEC 100000
+#define I2C_XFER_TIMEOUT_MICRO_SEC 1000
+#define I2C_MAX_RETRIES 2
+#define I2C_RECOVERY_CLOCK_PULSES 9
+#define I2C_RECOVERY_HALF_PERIOD_MICRO_SEC 5
 #define TCN75A_DEFAULT_ADDR 0x48
-#define AMBIENT_TEMP_REG 0b00
-#define SENSOR_CONFIG_REG 0b01
-#define TEMP_HYST_MIN_REG 0b10
-#define TEMP_SET_MAX_REG 0b11
 #define TCN75A_BAUDRATE (400 * 1000)
+#define I2C_MAX_REG_BYTES 2 // largest TCN75A register
+#define I2C_FIFO_DEPTH 16   // entries in each I2C controller FIFO
+// Typical conversion time for a resolution field of 0 (9 bit) to 3 (12 bit).
+#define TCN75A_CONVERSION_MS(res) (30 << (res))
+#define PIO_I2C_BAUDRATE TCN75A_BAUDRATE
+#define PIO_I2C_MAX_BAUDRATE (1000 * 1000)
+#define BENCH_ITERATIONS 1000
+#define BENCH_XIP_RUNS 100
+#define I2C_AUTOTUNE_TRIALS 4
+#define I2C_AUTOTUNE_MARGIN_PCT 20
+#define REG_CACHE_ENTRIES 16
+#define REG_CACHE_VERIFY_ON_WRITE false
+#define NUMBER_OF_PROFILES 4
+#define PROFILE_NAME_LEN 12
+#define PROFILE_NONE 0xFF
+#define PROFILE_MAGIC 0x464F5250 // "PROF"
+#define PROFILE_VERSION 1
+#define PROFILE_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define LOG_FLASH_SECTORS 64
+#define LOG_FLASH_OFFSET                                                       \
+  (PROFILE_FLASH_OFFSET - LOG_FLASH_SECTORS * FLASH_SECTOR_SIZE)
+#define LOG_RECORDS_PER_PAGE 30
+#define LOG_PAGE_MAGIC 0x474F4C53 // "SLOG"
+#define LOG_EXPORT_LINE_BYTES 32
+#define HISTORY_RAW_BLOCKS 8
+#define HISTORY_BLOCK_BYTES 64
+#define HISTORY_TIERS 3
+#define HISTORY_SECONDS 60
+#define HISTORY_MINUTES 60
+#define HISTORY_HOURS 24
+#define FILTER_MAX_WINDOW 8
+#define FILTER_MAX_EMA_SHIFT 7
+#define FILTER_CYCLE_BUDGET 400
+#define OVERSAMPLE_MAX_EXTRA_BITS 3
+#define OVERSAMPLE_MIN_SPACING_MS 20
+#define ALERT_DEFAULT_WARNING_C 30
+#define ALERT_DEFAULT_CRITICAL_C 40
+#define ALERT_DEFAULT_HYSTERESIS_C 1
+#define ALERT_DEFAULT_DEBOUNCE 3
+#define ADAPTIVE_CHANGE_RAW 32 // 0.125 C
+#define ADAPTIVE_NEAR_THRESHOLD_C 1
+#define ADAPTIVE_STABLE_READS 4
+#define ADAPTIVE_MAX_INTERVAL_MS 60000
+#define EVENT_QUEUE_LEN 32
+#define TREND_WINDOW_SHIFT 5
+#define TREND_DEFAULT_C_PER_MIN 1
+#define EDGE_CAPTURE_PIO pio1
+#define EDGE_CAPTURE_IRQ PIO1_IRQ_0
+#define EDGE_CAPTURE_BTN_BASE BTN4 // BTN4 to BTN0 are GP11 to GP15
+#define EDGE_CAPTURE_BTN_PINS 5
+#define EDGE_CAPTURE_CYCLES_PER_TICK 8
+#define EDGE_CAPTURE_RING_BITS 10 // 1 KB, 128 records per ring
+#define FAST_BOOT_BUFFER_LEN 256
+#define FAST_BOOT_USB_POLL_MS 50
+#define FAST_BOOT_CSV_LINE_BYTES 32
+#define POWER_IDLE_CLK_DIV 2 // keeps clk_sys above the 48 MHz of USB
+#define CONSOLE_BUFFER_BYTES 2048
+#define CONSOLE_CORE1_WAIT_US 100000
+#define CONSOLE_LINE_BYTES 128 // longest line of a core1 listing
+#define CONSOLE_DRAIN_MS 10
+#define CONSOLE_FLUSH_TIMEOUT_US 500000
+#define MENU_INPUT_LEN 12
+#define RAM_BUDGET_BYTES (128 * 1024) // of 256 KB, the rest is SDK and USB
+#define STACK_PAINT_WORD 0x4B435453   // "STCK"
+#define STACK_PAINT_MARGIN_WORDS 16
 #define BLINK_LED_DELAY 500
+#define SAMPLE_INTERVAL_MS (2 * BLINK_LED_DELAY)
 
 // Define additional constants for the number of GPIO pins, number of buttons,
 // and number of I2C devices used by the program.
 #define NUMBER_OF_GPIOS 9
 #define NUMBER_OF_BTNS 8
-#define NUMBER_OF_I2C 1
+#define NUMBER_OF_I2C 2
+#define NUMBER_OF_SENSORS 3
+#define ALL_SENSORS_MASK ((1u << NUMBER_OF_SENSORS) - 1)
 
-// Define bit masks for various configuration settings used by the TCN75A
-// temperature sensor.
-#define SHUTDOWN_MASK 0b00000001
-#define ALERT_MODE_MASK 0b00000010
-#define ALERT_POLARITY_MASK 0b00000100
-#define FAULT_QUEUE_MASK 0b00011000
-#define ADC_RESOLUTION_MASK 0b01100000
-#define ONE_SHOT_MASK 0b10000000
+// Worst-case time a single register transaction can stall the calling core:
+// every attempt may spend a full timeout on both the address and data phases,
+// and every retry is preceded by a bus recovery (SCL pulses plus a STOP).
+#define I2C_RECOVERY_MICRO_SEC                                                 \
+  ((2 * I2C_RECOVERY_CLOCK_PULSES + 6) * I2C_RECOVERY_HALF_PERIOD_MICRO_SEC)
+#define I2C_WORST_CASE_STALL_MICRO_SEC                                         \
+  ((I2C_MAX_RETRIES + 1) * 2 * I2C_XFER_TIMEOUT_MICRO_SEC +                    \
+   I2C_MAX_RETRIES * I2C_RECOVERY_MICRO_SEC)
+
+// Functions on the interrupt and sampling paths. Built with RAM_HOT_PATH they
+// are copied to SRAM at boot, so an XIP cache miss cannot stall them.
+#ifdef RAM_HOT_PATH
+#define HOT_PATH_FUNC(func_name) __not_in_flash_func(func_name)
+#else
+#define HOT_PATH_FUNC(func_name) func_name
+#endif
+
+// TCN75A register map, one line per register:
+// X(name, address, size in bytes)
+#define TCN75A_REGISTERS(X)                                                    \
+  X(AMBIENT_TEMP_REG, 0b00, 2)                                                 \
+  X(SENSOR_CONFIG_REG, 0b01, 1)                                                \
+  X(TEMP_HYST_MIN_REG, 0b10, 2)                                                \
+  X(TEMP_SET_MAX_REG, 0b11, 2)
+
+// TCN75A config register fields, one line per field, lowest bit first:
+// X(name, label, menu flag, shift, width, name of every value)
+#define TCN75A_CONFIG_FIELDS(X)                                                \
+  X(SHUTDOWN, "Shutdown", SHUTDOWN_MODE_SHIFT, 0, 1, "Disable", "Enable")      \
+  X(ALERT_MODE, "Alert Mode", COMP_INT_MODE_SHIFT, 1, 1, "Comparator",         \
+    "Interrupt")                                                               \
+  X(ALERT_POLARITY, "Alert Polarity", ALERT_POLARITY_SHIFT, 2, 1, "Low",       \
+    "High")                                                                    \
+  X(FAULT_QUEUE, "Fault Queue", FAULT_QUEUE_MODE_SHIFT, 3, 2, "1", "2", "4",   \
+    "6")                                                                       \
+  X(ADC_RESOLUTION, "ADC Resolution", ADC_RESOLUTION_SHIFT, 5, 2, "0.5C",      \
+    "0.25C", "0.125C", "0.0625C")                                              \
+  X(ONE_SHOT, "One-Shot", ONE_SHOT_MODE_SHIFT, 7, 1, "Disable", "Enable")
+
+// Register addresses, e.g. SENSOR_CONFIG_REG, and sizes, e.g.
+// SENSOR_CONFIG_REG_BYTES.
+#define TCN75A_REG_ADDRESS(name, address, bytes) name = (address),
+#define TCN75A_REG_BYTES(name, address, bytes) name##_BYTES = (bytes),
+enum TCN75A_REGISTER { TCN75A_REGISTERS(TCN75A_REG_ADDRESS) };
+enum TCN75A_REGISTER_BYTES { TCN75A_REGISTERS(TCN75A_REG_BYTES) };
+
+// Config register field masks, e.g. ADC_RESOLUTION_MASK, and indices into
+// config_fields, e.g. ADC_RESOLUTION_FIELD.
+#define TCN75A_FIELD_MASK(name, label, flag, shift, width, ...)                \
+  name##_MASK = ((1 << (width)) - 1) << (shift),
+#define TCN75A_FIELD_INDEX(name, label, flag, shift, width, ...) name##_FIELD,
+enum TCN75A_CONFIG_MASK { TCN75A_CONFIG_FIELDS(TCN75A_FIELD_MASK) };
+enum TCN75A_CONFIG_FIELD {
+  TCN75A_CONFIG_FIELDS(TCN75A_FIELD_INDEX) NUMBER_OF_CONFIG_FIELDS
+};
+
+// Bits implemented by the THYST and TSET registers (0.5 C resolution).
+#define TEMP_LIMIT_REG_MASK 0xFF80
 
 // Declare extern variables for the GPIO and I2C configurations used by the
 // program.
 extern const GpioConfig proj_gpio[NUMBER_OF_GPIOS];
 extern const I2CConfig proj_i2c[NUMBER_OF_I2C];
+extern SensorConfig proj_sensors[NUMBER_OF_SENSORS];
+extern PioI2C proj_pio_i2c;
 
 // Define values and shifts for various configurations of the device
 #define DISABLE_IRQ 0 // Value to disable interrupts
 #define ENABLE_IRQ 1  // Value to enable interrupts
-
-// Bit masks for various configuration settings
-#define SHUTDOWN_MODE_REQ_MASK 0b00000001    // Mask for shutdown mode req
-#define COMP_INT_MODE_REQ_MASK 0b00000010    // Mask for comp/int mode req
-#define ALERT_POLARITY_REQ_MASK 0b00000100   // Mask for alert polarity req
-#define FAULT_QUEUE_MODE_REQ_MASK 0b00011000 // Mask for fault queue mode req
-#define ADC_RESOLUTION_REQ_MASK 0b01100000   // Mask for ADC resolution req
-#define ONE_SHOT_MODE_REQ_MASK 0b10000000    // Mask for one-shot mode req
+#define PARK_CORE 2   // Value to park the core while flash is written
+#define CALL_CORE0 3  // Value to run a function from core1 on core0
 
 // Shift values for various configuration settings
 #define NO_CHANGE_SHIFT (1 << 16)        // Flag for no change req
@@ -71,6 +191,13 @@ extern const I2CConfig proj_i2c[NUMBER_OF_I2C];
 #define FAULT_QUEUE_MODE_SHIFT (1 << 28) // Flag for fault queue mode req
 #define ADC_RESOLUTION_SHIFT (1 << 27)   // Flag for ADC resolution req
 #define ONE_SHOT_MODE_SHIFT (1 << 26)    // Flag for one-shot mode req
+#define APPLY_ALL_SHIFT (1 << 25)        // Flag to apply to all sensors
+#define PROFILE_MENU_SHIFT (1 << 24)     // Flag for profile menu req
+#define LOG_MENU_SHIFT (1 << 23)         // Flag for sample log menu req
+#define HISTORY_MENU_SHIFT (1 << 22)     // Flag for history menu req
+#define FILTER_MENU_SHIFT (1 << 21)      // Flag for filter menu req
+#define OVERSAMPLE_MENU_SHIFT (1 << 20)  // Flag for oversampling menu req
+#define ADAPTIVE_MENU_SHIFT (1 << 19)    // Flag for adaptive rate menu req
 
 // End the preprocessor directive.
 #endif
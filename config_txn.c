@@ -0,0 +1,125 @@
+#include "config_txn.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "reg_cache.h"
+#include "tcn75a.h"
+
+/**
+ * @brief Starts an empty config transaction.
+ *
+ * @param txn A pointer to the transaction to reset.
+ *
+ * @return None.
+ */
+void config_txn_begin(ConfigTxn *txn) {
+  txn->mask = 0;
+  txn->bits = 0;
+}
+
+/**
+ * @brief Adds a field change to a config transaction.
+ *
+ * Setting the same field twice keeps the last value.
+ *
+ * @param txn A pointer to the transaction.
+ * @param field_mask The mask of the field, e.g. ADC_RESOLUTION_MASK.
+ * @param value The new field value, already in register position.
+ *
+ * @return None.
+ */
+void config_txn_set(ConfigTxn *txn, uint8_t field_mask, uint8_t value) {
+  txn->mask |= field_mask;
+  txn->bits = (txn->bits & ~field_mask) | (value & field_mask);
+}
+
+/**
+ * @brief Builds a config transaction from the result of show_config_menu.
+ *
+ * @param txn A pointer to the transaction to fill in.
+ * @param menu_result The value returned by show_config_menu.
+ *
+ * @return None.
+ */
+void config_txn_from_menu(ConfigTxn *txn, uint32_t menu_result) {
+  config_txn_begin(txn);
+  if (menu_result & NO_CHANGE_SHIFT) {
+    return;
+  }
+  for (size_t i = 0; i < NUMBER_OF_CONFIG_FIELDS; i++) {
+    if (menu_result & config_fields[i].menu_flag) {
+      config_txn_set(txn, config_fields[i].mask, menu_result & 0xFF);
+    }
+  }
+}
+
+/**
+ * @brief Applies a config transaction to one or more sensors.
+ *
+ * For every sensor, the complete target config is computed from the cached
+ * register, written in a single bus transaction, and read back from the
+ * device to verify it. A sensor whose cached register cannot be loaded is
+ * left untouched and fails, since its unchanged fields are unknown. The
+ * ONE-SHOT bit is excluded from verification, since the sensor clears it once
+ * its conversion has completed.
+ *
+ * @param txn A pointer to the transaction to apply.
+ * @param sensors The array of sensors to configure.
+ * @param len The number of sensors in the array.
+ * @param results The array that receives one result per sensor.
+ *
+ * @return The number of sensors that were configured and verified.
+ */
+size_t config_txn_apply(const ConfigTxn *txn, const SensorConfig *sensors,
+                        size_t len, ConfigTxnResult *results) {
+  size_t n_ok = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    uint8_t before = 0;
+    results[i].before = 0;
+    results[i].after = 0;
+    if (!reg_cache_read_config(&sensors[i], &before)) {
+      results[i].status = PICO_ERROR_GENERIC;
+      continue;
+    }
+    uint8_t target = (before & ~txn->mask) | txn->bits;
+
+    results[i].before = before;
+    results[i].status = reg_cache_write_config(&sensors[i], target);
+    if (results[i].status >= 0 && !reg_cache_refresh_config(&sensors[i])) {
+      results[i].status = PICO_ERROR_GENERIC;
+    }
+    reg_cache_read_config(&sensors[i], &results[i].after);
+    if (results[i].status >= 0 &&
+        ((results[i].after ^ target) & ~ONE_SHOT_MASK) != 0) {
+      results[i].status = PICO_ERROR_GENERIC;
+    }
+    if (results[i].status >= 0) {
+      n_ok++;
+    }
+  }
+  return n_ok;
+}
+
+/**
+ * @brief Prints the per-device outcome of a config transaction.
+ *
+ * @param sensors The array of sensors the transaction was applied to.
+ * @param results The array of results returned by config_txn_apply.
+ * @param len The number of sensors in the arrays.
+ *
+ * @return None.
+ */
+void print_config_txn_results(const SensorConfig *sensors,
+                              const ConfigTxnResult *results, size_t len) {
+  printf("+--------+------+--------+-------+---------+\n");
+  printf("| Sensor | Addr | Before | After | Result  |\n");
+  printf("+--------+------+--------+-------+---------+\n");
+  for (size_t i = 0; i < len; i++) {
+    printf("| %-6u | 0x%02x | 0x%02x   | 0x%02x  | %-7s |\n", (unsigned)i,
+           sensors[i].addr, results[i].before, results[i].after,
+           results[i].status >= 0 ? "OK" : "FAILED");
+  }
+  printf("+--------+------+--------+-------+---------+\n");
+}
@@ -0,0 +1,33 @@
+#ifndef __CONFIG_TXN_H__
+#define __CONFIG_TXN_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing a set of config register field changes
+// mask the config register bits being changed
+// bits the new values of the changed bits
+typedef struct {
+  uint8_t mask;
+  uint8_t bits;
+} ConfigTxn;
+
+// Struct for storing the outcome of a transaction on one device
+// status PICO_OK, or a PICO_ERROR code
+// before the config register before the write
+// after the config register read back after the write
+typedef struct {
+  int status;
+  uint8_t before;
+  uint8_t after;
+} ConfigTxnResult;
+
+void config_txn_begin(ConfigTxn *txn);
+void config_txn_set(ConfigTxn *txn, uint8_t field_mask, uint8_t value);
+void config_txn_from_menu(ConfigTxn *txn, uint32_t menu_result);
+size_t config_txn_apply(const ConfigTxn *txn, const SensorConfig *sensors,
+                        size_t len, ConfigTxnResult *results);
+void print_config_txn_results(const SensorConfig *sensors,
+                              const ConfigTxnResult *results, size_t len);
+
+#endif
@@ -0,0 +1,214 @@
+#include "console.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "hardware/sync.h"
+#include "pico/stdio.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+
+// Single-producer, single-consumer byte ring. The producer is the core that
+// owns the ring and the consumer is console_drain on core0. head and tail
+// count bytes and are only reduced modulo the size when indexing, so the
+// whole buffer can be used.
+typedef struct {
+  char bytes[CONSOLE_BUFFER_BYTES];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+} ConsoleRing;
+
+static ConsoleRing rings[NUM_CORES];
+static ConsoleStats console_stats[NUM_CORES] = {0};
+
+/**
+ * @brief Copies a write from printf or puts into the calling core's ring.
+ *
+ * This runs with the stdio mutex held, which core0's own printing needs, and
+ * core0 is the only core that drains the rings, so it must never wait. What
+ * does not fit is dropped and counted. Callers with long output on core1 make
+ * room beforehand with console_wait_space.
+ *
+ * @param buf The characters to write.
+ * @param len The number of characters.
+ *
+ * @return None.
+ */
+static void console_out_chars(const char *buf, int len) {
+  uint core = get_core_num();
+  ConsoleRing *ring = &rings[core];
+  ConsoleStats *stats = &console_stats[core];
+  uint32_t used = ring->head - ring->tail;
+  uint32_t n = MIN((uint32_t)len, CONSOLE_BUFFER_BYTES - used);
+  if (n < (uint32_t)len) {
+    stats->dropped += len - n;
+    stats->dropped_writes++;
+  }
+  if (n == 0) {
+    return;
+  }
+  uint32_t start = ring->head % CONSOLE_BUFFER_BYTES;
+  uint32_t first = MIN(n, CONSOLE_BUFFER_BYTES - start);
+  memcpy(&ring->bytes[start], buf, first);
+  memcpy(ring->bytes, buf + first, n - first);
+  __dmb();
+  ring->head += n;
+  stats->written += n;
+  if (used + n > stats->high_water) {
+    stats->high_water = used + n;
+  }
+  // Wake core0 from its idle wait so the output goes out without waiting
+  // for the next task deadline.
+  __sev();
+}
+
+/**
+ * @brief Reads input from the USB serial port, which is not buffered here.
+ *
+ * @param buf A buffer that receives the characters.
+ * @param len The size of buf.
+ *
+ * @return The number of characters read, or PICO_ERROR_NO_DATA.
+ */
+static int console_in_chars(char *buf, int len) {
+  return stdio_usb.in_chars(buf, len);
+}
+
+static stdio_driver_t console_driver = {
+    .out_chars = console_out_chars,
+    .in_chars = console_in_chars,
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+};
+
+/**
+ * @brief Routes stdout through the per-core console buffers. Must be called
+ * after stdio_init_all; the USB driver is only used by console_drain from
+ * then on.
+ *
+ * @return None.
+ */
+void console_init() {
+  stdio_set_driver_enabled(&stdio_usb, false);
+  stdio_set_driver_enabled(&console_driver, true);
+}
+
+/**
+ * @brief Returns how much output the calling core can write before its
+ * console buffer is full, so that long listings can be printed in parts.
+ *
+ * @return The number of free bytes in the calling core's buffer.
+ */
+uint32_t console_space() {
+  ConsoleRing *ring = &rings[get_core_num()];
+  return CONSOLE_BUFFER_BYTES - (ring->head - ring->tail);
+}
+
+/**
+ * @brief Waits until the calling core's console buffer has room for a line.
+ * Must only be called from core1, and never from inside printf.
+ *
+ * Core1 calls this between the lines of long listings, so core0 can drain
+ * the buffer while no stdio lock is held. It gives up after
+ * CONSOLE_CORE1_WAIT_US, e.g. while no host is reading.
+ *
+ * @param bytes The number of bytes the next output needs.
+ *
+ * @return true if there is room, false if the wait timed out.
+ */
+bool console_wait_space(uint32_t bytes) {
+  absolute_time_t timeout = make_timeout_time_us(CONSOLE_CORE1_WAIT_US);
+  while (console_space() < bytes) {
+    if (time_reached(timeout)) {
+      return false;
+    }
+    __sev();
+    tight_loop_contents();
+  }
+  return true;
+}
+
+/**
+ * @brief Returns whether buffered output can be sent to the host now.
+ *
+ * @return true if a console buffer holds output and the USB serial port has
+ * room for it.
+ */
+bool console_pending() {
+  bool has_output = false;
+  for (int i = 0; i < NUM_CORES; i++) {
+    has_output |= rings[i].head != rings[i].tail;
+  }
+  return has_output &&
+         (!stdio_usb_connected() || tud_cdc_write_available() > 0);
+}
+
+/**
+ * @brief Moves as much buffered output to the USB serial port as it can take
+ * without waiting. Must only be called from core0.
+ *
+ * Output is discarded while no host has the port open, since USB would
+ * discard it anyway.
+ *
+ * @return true if output is left in a buffer.
+ */
+bool console_drain() {
+  bool is_connected = stdio_usb_connected();
+  bool has_output = false;
+  for (int i = 0; i < NUM_CORES; i++) {
+    ConsoleRing *ring = &rings[i];
+    uint32_t head = ring->head;
+    __dmb();
+    while (ring->tail != head) {
+      uint32_t start = ring->tail % CONSOLE_BUFFER_BYTES;
+      uint32_t len = MIN(head - ring->tail, CONSOLE_BUFFER_BYTES - start);
+      if (is_connected) {
+        len = MIN(len, tud_cdc_write_available());
+        if (len == 0) {
+          break;
+        }
+        stdio_usb.out_chars(&ring->bytes[start], len);
+      }
+      __dmb();
+      ring->tail += len;
+    }
+    has_output |= ring->tail != ring->head;
+  }
+  return has_output;
+}
+
+/**
+ * @brief Drains the console buffers until they are empty, for output that is
+ * printed before the console task runs. Must only be called from core0.
+ *
+ * @param timeout_us How long to wait for a host that is not reading.
+ *
+ * @return true if every buffer was emptied.
+ */
+bool console_flush(uint32_t timeout_us) {
+  absolute_time_t timeout = make_timeout_time_us(timeout_us);
+  while (console_drain()) {
+    if (time_reached(timeout)) {
+      return false;
+    }
+    tight_loop_contents();
+  }
+  return true;
+}
+
+/**
+ * @brief Prints how much console output each core wrote and dropped.
+ *
+ * @return None.
+ */
+void print_console_stats() {
+  printf("\nConsole output:\n");
+  for (int i = 0; i < NUM_CORES; i++) {
+    ConsoleStats *stats = &console_stats[i];
+    printf("core%d: %lu bytes written, %lu bytes of %lu writes dropped, "
+           "%lu of %d bytes buffered at most\n",
+           i, (unsigned long)stats->written, (unsigned long)stats->dropped,
+           (unsigned long)stats->dropped_writes,
+           (unsigned long)stats->high_water, CONSOLE_BUFFER_BYTES);
+  }
+}
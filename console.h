@@ -0,0 +1,26 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include "pico/stdlib.h"
+
+// Struct for storing the statistics of one core's console buffer
+// written the number of bytes accepted into the buffer
+// dropped the number of bytes discarded because the buffer was full
+// dropped_writes the number of writes cut short because the buffer was full
+// high_water the largest number of bytes the buffer has held
+typedef struct {
+  uint32_t written;
+  uint32_t dropped;
+  uint32_t dropped_writes;
+  uint32_t high_water;
+} ConsoleStats;
+
+void console_init();
+uint32_t console_space();
+bool console_wait_space(uint32_t bytes);
+bool console_pending();
+bool console_drain();
+bool console_flush(uint32_t timeout_us);
+void print_console_stats();
+
+#endif
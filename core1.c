@@ -2,36 +2,72 @@
 
 #include <stdio.h>
 
+#include "adaptive_rate.h"
+#include "alert_engine.h"
+#include "alert_irq.h"
 #include "config.h"
+#include "config_txn.h"
+#include "console.h"
 #include "debounce.h"
+#include "edge_capture.h"
+#include "event_loop.h"
+#include "fast_boot.h"
+#include "filter.h"
 #include "globals.h"
 #include "gpio_util.h"
+#include "history.h"
+#include "i2c_autotune.h"
+#include "mem_plan.h"
 #include "menu_handler.h"
+#include "oversample.h"
+#include "power.h"
 #include "pico/multicore.h"
+#include "profile.h"
+#include "reg_cache.h"
+#include "sample_log.h"
+#include "sensor_poll.h"
+#include "tcn75a.h"
+#include "trend.h"
 #include "pico/stdlib.h"
 
+// Status reports printed after the bus scan, in order. Each one waits for
+// room in the console buffer first, so the listing is not cut short.
+static void (*const status_printers[])() = {
+    print_i2c_recovery_stats, print_bus_utilization, print_adaptive_rates,
+    print_sample_log_stats,   print_alert_irq_stats, print_edge_stats,
+    print_event_loop_stats,   print_power_stats,     print_boot_times,
+    print_console_stats,      print_memory_plan,
+};
+
 /**
  * @brief Entry point for core1.
  *
- * This function is the entry point for the second core. It continuously
- * monitors an input GPIO pin for any alerts, and updates two output GPIO pins
- * to indicate the alert status. It also checks the multicore FIFO for any
- * pending requests, and calls the `handle_request()` function to handle them.
+ * This function is the entry point for the second core. It checks the
+ * multicore FIFO for any pending requests, and calls the `handle_request()`
+ * function to handle the most recent one, discarding presses that queued up
+ * while it was busy. Between requests it writes full sample log pages
+ * to flash. When there is nothing to do it waits for an event from core0
+ * instead of spinning.
  *
  * @return void
  */
 void core1_entry() {
-    uint32_t request = 0xFFFFFFFF;
-
     while (1) {
-        bool has_alert_N = !gpio_get(ALERT_GP);
-        gpio_put(LED1, has_alert_N);
-        gpio_put(LED0, !has_alert_N);
-
+        bool is_busy = false;
         if (multicore_fifo_rvalid()) {
             uint32_t request = multicore_fifo_pop_blocking();
+            // Only the latest button press counts; older ones are stale.
+            while (multicore_fifo_rvalid()) {
+                request = multicore_fifo_pop_blocking();
+            }
             handle_request(request);
+            is_busy = true;
         }
+
+        if (sample_log_service() || is_busy) {
+            continue;
+        }
+        power_core1_wait();
     }
 }
 
@@ -41,7 +77,7 @@ void core1_entry() {
  * This function takes a request code as a parameter and performs the
  * appropriate action based on the request. The supported requests and their
  * corresponding actions are as follows:
- * - SCAN_I2C_BUS: Shows the landing page and scans the I2C bus for devices.
+ * - SCAN_I2C_BUS: Shows the landing page and scans every I2C bus for devices.
  * - SHOW_CONFIG: Displays the configuration settings.
  * - SHOW_DEV_ID: Displays the device ID.
  * - SHOW_ALERT_MENU: Displays the alert menu.
@@ -55,7 +91,14 @@ void handle_request(uint32_t request) {
     switch (request) {
         case SCAN_I2C_BUS:
             show_landing_page();
-            scan_i2c_bus(i2c, I2C_READ_TIMEOUT_MICRO_SEC);
+            for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+                scan_i2c_bus(proj_i2c[bus].i2c_inst,
+                             I2C_READ_TIMEOUT_MICRO_SEC);
+            }
+            for (size_t i = 0; i < count_of(status_printers); i++) {
+                console_wait_space(CONSOLE_BUFFER_BYTES / 2);
+                status_printers[i]();
+            }
             multicore_fifo_drain();
             break;
         case SHOW_CONFIG:
@@ -76,17 +119,21 @@ void handle_request(uint32_t request) {
  * @brief Displays the configuration menu and handles the user's configuration
  * choice.
  *
- * This function displays the configuration menu and waits for the user to make
- * a configuration choice. It then applies the corresponding configuration
- * change to the device, and displays the updated configuration status. The
- * supported configuration options and their corresponding bit masks are as
- * follows:
- * - Shutdown mode: SHUTDOWN_MODE_REQ_MASK
- * - Comparator/Interrupt mode: COMP_INT_MODE_REQ_MASK
- * - Alert polarity: ALERT_POLARITY_REQ_MASK
- * - Fault queue mode: FAULT_QUEUE_MODE_REQ_MASK
- * - ADC resolution: ADC_RESOLUTION_REQ_MASK
- * - One-shot mode: ONE_SHOT_MODE_REQ_MASK
+ * This function displays the configuration menu and waits for the user to stage
+ * one or more configuration changes. It then applies them as a single config
+ * transaction to the current sensor, or to every sensor in proj_sensors,
+ * displays the per-device results, and displays the updated configuration
+ * status. The supported configuration options are the fields of
+ * TCN75A_CONFIG_FIELDS in config.h:
+ * - Shutdown mode: SHUTDOWN_MASK
+ * - Comparator/Interrupt mode: ALERT_MODE_MASK
+ * - Alert polarity: ALERT_POLARITY_MASK
+ * - Fault queue mode: FAULT_QUEUE_MASK
+ * - ADC resolution: ADC_RESOLUTION_MASK
+ * - One-shot mode: ONE_SHOT_MASK
+ *
+ * The current configuration is taken from the register shadow cache, so a
+ * visit costs one bus write and one verification read per device.
  *
  * If the user does not make a valid configuration choice, or chooses to make no
  * change, the function does nothing. Additionally, the function disables
@@ -96,44 +143,234 @@ void handle_request(uint32_t request) {
  * @return void
  */
 void handle_show_config() {
-    multicore_fifo_push_blocking(DISABLE_IRQ);
+    event_loop_post(DISABLE_IRQ);
+    SensorConfig sensor = {.i2c_inst = i2c, .addr = dev_addr};
     uint32_t user_config_result = show_config_menu();
-    uint8_t curr_config_result = read_config(i2c, dev_addr);
-    uint8_t new_config_result = 0x0;
-    bool has_new_change = true;
-    if (user_config_result & NO_CHANGE_SHIFT) {
-        has_new_change = false;
-    } else if (user_config_result & SHUTDOWN_MODE_SHIFT) {
-        new_config_result = (curr_config_result & ~SHUTDOWN_MODE_REQ_MASK) |
-                            (user_config_result & SHUTDOWN_MODE_REQ_MASK);
-    } else if (user_config_result & COMP_INT_MODE_SHIFT) {
-        new_config_result = (curr_config_result & ~COMP_INT_MODE_REQ_MASK) |
-                            (user_config_result & COMP_INT_MODE_REQ_MASK);
-    } else if (user_config_result & ALERT_POLARITY_SHIFT) {
-        new_config_result = (curr_config_result & ~ALERT_POLARITY_REQ_MASK) |
-                            (user_config_result & ALERT_POLARITY_REQ_MASK);
-    } else if (user_config_result & FAULT_QUEUE_MODE_SHIFT) {
-        new_config_result = (curr_config_result & ~FAULT_QUEUE_MODE_REQ_MASK) |
-                            (user_config_result & FAULT_QUEUE_MODE_REQ_MASK);
-    } else if (user_config_result & ADC_RESOLUTION_SHIFT) {
-        new_config_result = (curr_config_result & ~ADC_RESOLUTION_REQ_MASK) |
-                            (user_config_result & ADC_RESOLUTION_REQ_MASK);
-    } else if (user_config_result & ONE_SHOT_MODE_SHIFT) {
-        new_config_result = (curr_config_result & ~ONE_SHOT_MODE_REQ_MASK) |
-                            (user_config_result & ONE_SHOT_MODE_REQ_MASK);
+    if (user_config_result & PROFILE_MENU_SHIFT) {
+        handle_show_profile_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    if (user_config_result & LOG_MENU_SHIFT) {
+        handle_show_log_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    if (user_config_result & HISTORY_MENU_SHIFT) {
+        handle_show_history_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    if (user_config_result & FILTER_MENU_SHIFT) {
+        handle_show_filter_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    if (user_config_result & OVERSAMPLE_MENU_SHIFT) {
+        handle_show_oversample_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    if (user_config_result & ADAPTIVE_MENU_SHIFT) {
+        handle_show_adaptive_menu();
+        event_loop_post(ENABLE_IRQ);
+        return;
+    }
+    ConfigTxn txn;
+    ConfigTxnResult results[NUMBER_OF_SENSORS];
+    config_txn_from_menu(&txn, user_config_result);
+
+    show_landing_page();
+    if (txn.mask != 0) {
+        if (user_config_result & APPLY_ALL_SHIFT) {
+            config_txn_apply(&txn, proj_sensors, NUMBER_OF_SENSORS, results);
+            print_config_txn_results(proj_sensors, results,
+                                     NUMBER_OF_SENSORS);
+        } else {
+            config_txn_apply(&txn, &sensor, 1, results);
+            print_config_txn_results(&sensor, results, 1);
+        }
+    }
+
+    uint8_t config_result;
+    if (reg_cache_read_config(&sensor, &config_result)) {
+        alert_irq_set_polarity(config_result & ALERT_POLARITY_MASK);
+        printf("Sensor Config Status\n");
+        parse_config(config_result);
     } else {
-        has_new_change = false;
+        printf("[WARNING] Could not read the sensor config\n");
+    }
+    event_loop_post(ENABLE_IRQ);
+}
+
+/**
+ * @brief Displays the profile menu and handles the user's profile choice.
+ *
+ * This function displays the profile menu and performs the selected action:
+ * - PROFILE_SAVE: Captures the current settings into the selected slot.
+ * - PROFILE_LOAD: Applies the selected profile immediately.
+ * - PROFILE_SET_BOOT: Applies the selected profile at every boot.
+ * - PROFILE_CLEAR_BOOT: Boots with the sensors' power-on defaults.
+ * - PROFILE_TUNE_BUSES: Auto-tunes the bus clocks, kept by saving a profile.
+ *
+ * Writes to flash park core0 while the profile sector is reprogrammed.
+ *
+ * @return void
+ */
+void handle_show_profile_menu() {
+    uint8_t slot = 0;
+    char name[PROFILE_NAME_LEN] = {0};
+    uint32_t result = show_profile_menu(&slot, name);
+    show_landing_page();
+
+    bool is_success = true;
+    if (result == PROFILE_SAVE) {
+        ConfigProfile profile;
+        is_success = profile_capture(&profile, name) &&
+                     profile_save(slot, &profile);
+    } else if (result == PROFILE_LOAD) {
+        const ProfileStore *store = profile_store();
+        is_success = store != NULL && profile_apply(&store->profiles[slot]);
+    } else if (result == PROFILE_SET_BOOT) {
+        is_success = profile_set_active(slot);
+    } else if (result == PROFILE_CLEAR_BOOT) {
+        is_success = profile_set_active(PROFILE_NONE);
+    } else if (result == PROFILE_TUNE_BUSES) {
+        autotune_i2c_buses();
+    }
+
+    if (result != PROFILE_NO_CHANGE) {
+        printf(is_success ? "[SUCCCESS] Profile updated\n"
+                          : "[WARNING] Profile operation failed\n");
+    }
+    print_profiles();
+}
+
+/**
+ * @brief Displays the sample log menu and streams the selected time range.
+ *
+ * @return void
+ */
+void handle_show_log_menu() {
+    uint32_t from_ms = 0;
+    uint32_t to_ms = 0;
+    bool is_compressed = false;
+    bool is_export = show_log_menu(&from_ms, &to_ms, &is_compressed);
+    show_landing_page();
+
+    if (is_export && is_compressed) {
+        sample_log_export_compressed(from_ms, to_ms);
+    } else if (is_export) {
+        sample_log_export(from_ms, to_ms);
+    }
+    print_sample_log_stats();
+}
+
+/**
+ * @brief Displays the history menu and prints the selected tiers.
+ *
+ * @return void
+ */
+void handle_show_history_menu() {
+    int tier = show_history_menu();
+    show_landing_page();
+
+    if (tier == HISTORY_TIERS + 1) {
+        for (uint t = 1; t <= HISTORY_TIERS; t++) {
+            print_history(t);
+        }
+    } else if (tier >= 0) {
+        print_history(tier);
+    }
+}
+
+/**
+ * @brief Applies a filter setting. Runs on core0, which filters every
+ * sample.
+ *
+ * @param ctx The sensor index, the filter type and the filter parameter.
+ *
+ * @return true if the filter was set, false if the parameter is invalid.
+ */
+static bool apply_filter(const void *ctx) {
+    const uint8_t *setting = ctx;
+    return filter_configure(setting[0], setting[1], setting[2]);
+}
+
+/**
+ * @brief Displays the filter menu and applies the selected filter on core0.
+ *
+ * @return void
+ */
+void handle_show_filter_menu() {
+    uint8_t setting[3] = {0, FILTER_NONE, 0};
+    bool is_selected =
+        show_filter_menu(&setting[0], &setting[1], &setting[2]);
+    show_landing_page();
+
+    if (is_selected && !event_loop_call(apply_filter, setting)) {
+        printf("[ERROR] Invalid filter parameter %u\n", setting[2]);
     }
+    print_filters();
+}
 
-    if (has_new_change) {
-        write_config(i2c, dev_addr, new_config_result);
+/**
+ * @brief Applies an oversampling setting. Runs on core0, which services the
+ * oversamplers.
+ *
+ * @param ctx The sensor index followed by the number of extra bits.
+ *
+ * @return true if the setting was applied, false if it is out of range.
+ */
+static bool apply_oversample(const void *ctx) {
+    const uint8_t *setting = ctx;
+    return oversample_configure(setting[0], setting[1]);
+}
+
+/**
+ * @brief Displays the oversampling menu and applies the selected setting on
+ * core0.
+ *
+ * @return void
+ */
+void handle_show_oversample_menu() {
+    uint8_t setting[2] = {0};
+    if (show_oversample_menu(&setting[0], &setting[1])) {
+        event_loop_call(apply_oversample, setting);
     }
+    show_landing_page();
+    print_oversampling();
+}
+
+/**
+ * @brief Applies an adaptive sampling range. Runs on core0, which updates
+ * the sampling periods and deadlines after every poll.
+ *
+ * @param ctx The shortest period followed by the longest period in ms.
+ *
+ * @return true if the range was applied, false if it is invalid.
+ */
+static bool apply_adaptive(const void *ctx) {
+    const uint32_t *range = ctx;
+    return adaptive_configure(range[0], range[1]);
+}
 
+/**
+ * @brief Displays the adaptive sampling menu and applies the selected range
+ * on core0.
+ *
+ * @return void
+ */
+void handle_show_adaptive_menu() {
+    uint32_t range[2] = {0};
+    bool is_selected = show_adaptive_menu(&range[0], &range[1]);
     show_landing_page();
-    uint8_t config_result = read_config(i2c, dev_addr);
-    printf("Sensor Config Status\n");
-    parse_config(config_result);
-    multicore_fifo_push_blocking(ENABLE_IRQ);
+
+    if (is_selected && !event_loop_call(apply_adaptive, range)) {
+        printf("[ERROR] Invalid sampling periods %lu to %lu ms\n",
+               (unsigned long)range[0], (unsigned long)range[1]);
+    }
+    print_adaptive_rates();
 }
 
 /**
@@ -150,10 +387,10 @@ void handle_show_config() {
  * @return void
  */
 void handle_show_dev_id() {
-    multicore_fifo_push_blocking(DISABLE_IRQ);
+    event_loop_post(DISABLE_IRQ);
     uint8_t addr = show_dev_change_menu(TCN75A_DEFAULT_ADDR);
     show_landing_page();
-    multicore_fifo_push_blocking(ENABLE_IRQ);
+    event_loop_post(ENABLE_IRQ);
 
     if (addr != 0) {
         uint8_t rxdata;
@@ -170,6 +407,48 @@ void handle_show_dev_id() {
     multicore_fifo_drain();
 }
 
+// Struct for storing firmware alert thresholds on their way to core0
+// sensor the proj_sensors index of the sensor
+// thresholds the thresholds to set
+typedef struct {
+    uint8_t sensor;
+    AlertThresholds thresholds;
+} ThresholdSetting;
+
+// Struct for storing a trend threshold on its way to core0
+// sensor the proj_sensors index of the sensor
+// threshold the rate of change in 1/256 C per minute, 0 to disable
+typedef struct {
+    uint8_t sensor;
+    int32_t threshold;
+} TrendSetting;
+
+/**
+ * @brief Applies firmware alert thresholds. Runs on core0, which evaluates
+ * them on every sample.
+ *
+ * @param ctx A pointer to the ThresholdSetting to apply.
+ *
+ * @return true if the thresholds were set, false if they are invalid.
+ */
+static bool apply_thresholds(const void *ctx) {
+    const ThresholdSetting *setting = ctx;
+    return alert_set_thresholds(setting->sensor, &setting->thresholds);
+}
+
+/**
+ * @brief Applies a trend threshold. Runs on core0, which evaluates it on
+ * every sample.
+ *
+ * @param ctx A pointer to the TrendSetting to apply.
+ *
+ * @return true if the threshold was set, false if it is invalid.
+ */
+static bool apply_trend(const void *ctx) {
+    const TrendSetting *setting = ctx;
+    return trend_set_threshold(setting->sensor, setting->threshold);
+}
+
 /**
  * @brief Displays the alert menu and handles the user's alert choice.
  *
@@ -183,6 +462,11 @@ void handle_show_dev_id() {
  * two-byte buffer passed by the user.
  * - WRITE_TEMP_SET_LIMIT: Writes the temperature set limit using the two-byte
  * buffer passed by the user.
+ * - EDIT_SENSOR_THRESHOLDS: Sets the firmware alert thresholds of a sensor.
+ * - EDIT_TREND_THRESHOLD: Sets the trend threshold of a sensor.
+ *
+ * Both thresholds are applied on core0 through event_loop_call, since the
+ * sampling task evaluates them.
  *
  * If the user does not make a valid alert choice, or chooses to perform no
  * action, the function does nothing. Additionally, the function disables
@@ -192,7 +476,7 @@ void handle_show_dev_id() {
  * @return void
  */
 void handle_show_alert_menu() {
-    multicore_fifo_push_blocking(DISABLE_IRQ);
+    event_loop_post(DISABLE_IRQ);
     uint8_t buf[2];
     uint32_t result = show_alert_menu(buf);
     show_landing_page();
@@ -205,7 +489,21 @@ void handle_show_alert_menu() {
         write_temp_hyst_limit(i2c, dev_addr, buf[0], buf[1]);
     } else if ((result & WRITE_TEMP_SET_LIMIT) && WRITE_TEMP_SET_LIMIT) {
         write_temp_set_limit(i2c, dev_addr, buf[0], buf[1]);
+    } else if (result & EDIT_SENSOR_THRESHOLDS) {
+        ThresholdSetting setting = {0};
+        if (show_threshold_menu(&setting.sensor, &setting.thresholds) &&
+            !event_loop_call(apply_thresholds, &setting)) {
+            printf("[ERROR] Invalid thresholds\n");
+        }
+        print_alert_levels();
+    } else if (result & EDIT_TREND_THRESHOLD) {
+        TrendSetting setting = {0};
+        if (show_trend_menu(&setting.sensor, &setting.threshold) &&
+            !event_loop_call(apply_trend, &setting)) {
+            printf("[ERROR] Invalid rate\n");
+        }
+        print_trends();
     }
 
-    multicore_fifo_push_blocking(ENABLE_IRQ);
+    event_loop_post(ENABLE_IRQ);
 }
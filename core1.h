@@ -4,6 +4,12 @@
 
 void handle_request(uint32_t request);
 void handle_show_config();
+void handle_show_profile_menu();
+void handle_show_log_menu();
+void handle_show_history_menu();
+void handle_show_filter_menu();
+void handle_show_oversample_menu();
+void handle_show_adaptive_menu();
 void handle_show_dev_id();
 void handle_show_alert_menu();
 
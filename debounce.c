@@ -2,6 +2,8 @@
 
 #include <stdio.h>
 
+#include "config.h"
+
 
 /**
  * @brief Check if the button state has been stable for a sufficient amount of
@@ -12,8 +14,8 @@
  * @return true if the button state has been stable for a sufficient amount of
  * time, false otherwise.
  */
-bool is_stable(const absolute_time_t prev_time,
-               const absolute_time_t curr_time) {
+bool HOT_PATH_FUNC(is_stable)(const absolute_time_t prev_time,
+                              const absolute_time_t curr_time) {
   if (curr_time < prev_time) {
     return false;
   }
@@ -31,7 +33,7 @@ bool is_stable(const absolute_time_t prev_time,
  * @param curr_state The current state of the button.
  * @return true if the button state has changed, false otherwise.
  */
-bool has_changed(bool prev_state, bool curr_state) {
+bool HOT_PATH_FUNC(has_changed)(bool prev_state, bool curr_state) {
   bool changed = (prev_state ^ curr_state);
   return changed;
 }
@@ -44,7 +46,7 @@ bool has_changed(bool prev_state, bool curr_state) {
  * @return true if the button state has changed and has been stable for a
  * sufficient amount of time, false otherwise.
  */
-bool debounce(const volatile BtnState btn) {
+bool HOT_PATH_FUNC(debounce)(const volatile BtnState btn) {
   if (has_changed(btn.prev_state, btn.curr_state)) {
     if (is_stable(btn.prev_time, btn.curr_time)) {
       return true;
@@ -58,7 +60,7 @@ bool debounce(const volatile BtnState btn) {
  *
  * @param btn The button state to be updated.
  */
-void set_rising_edge_state(volatile BtnState *btn) {
+void HOT_PATH_FUNC(set_rising_edge_state)(volatile BtnState *btn) {
   btn->prev_state = 0;
   btn->curr_state = 1;
   btn->prev_time = get_absolute_time();
@@ -70,7 +72,7 @@ void set_rising_edge_state(volatile BtnState *btn) {
  *
  * @param btn The button state to be updated.
  */
-void set_falling_edge_state(volatile BtnState *btn) {
+void HOT_PATH_FUNC(set_falling_edge_state)(volatile BtnState *btn) {
   btn->prev_state = 1;
   btn->curr_state = 0;
   btn->curr_time = get_absolute_time();
@@ -81,7 +83,7 @@ void set_falling_edge_state(volatile BtnState *btn) {
  *
  * @param btn The button state to be reset.
  */
-void reset_btn_state(volatile BtnState *btn) {
+void HOT_PATH_FUNC(reset_btn_state)(volatile BtnState *btn) {
   btn->prev_state = 0;
   btn->curr_state = 0;
   btn->prev_time = 0;
@@ -93,7 +95,7 @@ void reset_btn_state(volatile BtnState *btn) {
  *
  * @param btn The button state to be updated.
  */
-void update_btn_state(volatile BtnState *btn) {
+void HOT_PATH_FUNC(update_btn_state)(volatile BtnState *btn) {
   btn->prev_state = btn->curr_state;
   btn->curr_state = gpio_get(btn->but_pin);
 }
@@ -103,7 +105,7 @@ void update_btn_state(volatile BtnState *btn) {
  *
  * @param btn The button state whose time stamps are to be updated.
  */
-void update_btn_time(volatile BtnState *btn) {
+void HOT_PATH_FUNC(update_btn_time)(volatile BtnState *btn) {
   btn->prev_time = btn->curr_time;
   btn->curr_time = get_absolute_time();
 }
@@ -0,0 +1,312 @@
+#include "edge_capture.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "alert_irq.h"
+#include "edge_capture.pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+
+#define EDGE_RING_WORDS (1u << EDGE_CAPTURE_RING_BITS >> 2)
+
+// Divider of the state machines at full clk_sys. With LOW_POWER it matches
+// POWER_IDLE_CLK_DIV, so dropping it to 1 while clk_sys is slowed keeps the
+// tick rate constant.
+#ifdef LOW_POWER
+#define EDGE_CAPTURE_CLK_DIV POWER_IDLE_CLK_DIV
+#else
+#define EDGE_CAPTURE_CLK_DIV 1
+#endif
+
+// Indices of the two capture channels.
+enum EDGE_CHANNELS { EDGE_BTNS, EDGE_ALERT, NUMBER_OF_EDGE_CHANNELS };
+
+// Struct for storing the state of one capture channel
+// sm the state machine sampling the pins
+// dma_chan the DMA channel draining its RX FIFO into ring
+// read_words the number of ring words consumed, counted like the DMA writes
+// pins the last pin state read
+// has_state whether the initial state record has been read
+typedef struct {
+  uint sm;
+  uint dma_chan;
+  uint32_t read_words;
+  uint32_t pins;
+  bool has_state;
+} EdgeChannel;
+
+// DMA write rings, aligned to their size for the DMA ring wrap.
+static uint32_t rings[NUMBER_OF_EDGE_CHANNELS][EDGE_RING_WORDS]
+    __attribute__((aligned(1u << EDGE_CAPTURE_RING_BITS)));
+static EdgeChannel channels[NUMBER_OF_EDGE_CHANNELS];
+static bool is_started = false;
+// Tick of the last record read and the system time it was read at, which
+// the current tick is estimated from.
+static uint64_t anchor_ticks = 0;
+static uint64_t anchor_us = 0;
+static AlertTiming alert_timing = {0};
+static EdgeStats edge_stats = {0};
+// Odd while service_channel is updating the statistics and the anchor, so
+// print_edge_stats on core1 can detect a copy that overlapped an update.
+static volatile uint32_t stats_seq = 0;
+
+/**
+ * @brief Loads a copy of the edge_capture program sampling a number of pins
+ * and starts a state machine on it, without enabling it.
+ *
+ * @param channel The channel to set up.
+ * @param pin The lowest pin to sample.
+ * @param count The number of consecutive pins to sample.
+ *
+ * @return None.
+ */
+static void init_channel(EdgeChannel *channel, uint pin, uint count) {
+  PIO pio = EDGE_CAPTURE_PIO;
+  uint16_t instructions[count_of(edge_capture_program_instructions)];
+  memcpy(instructions, edge_capture_program_instructions,
+         sizeof(instructions));
+  instructions[edge_capture_offset_sample] = pio_encode_in(pio_pins, count);
+  pio_program_t program = {.instructions = instructions,
+                           .length = count_of(instructions),
+                           .origin = -1};
+  uint offset = pio_add_program(pio, &program);
+
+  channel->sm = pio_claim_unused_sm(pio, true);
+  pio_sm_config c = edge_capture_program_get_default_config(offset);
+  sm_config_set_in_pins(&c, pin);
+  sm_config_set_in_shift(&c, false, false, 32);
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+  sm_config_set_clkdiv_int_frac(&c, EDGE_CAPTURE_CLK_DIV, 0);
+  pio_sm_init(pio, channel->sm, offset + edge_capture_offset_loop, &c);
+  pio_sm_exec(pio, channel->sm, pio_encode_set(pio_y, 0));
+  pio_sm_exec(pio, channel->sm, pio_encode_mov(pio_osr, pio_null));
+
+  channel->dma_chan = dma_claim_unused_channel(true);
+  dma_channel_config d = dma_channel_get_default_config(channel->dma_chan);
+  channel_config_set_transfer_data_size(&d, DMA_SIZE_32);
+  channel_config_set_read_increment(&d, false);
+  channel_config_set_write_increment(&d, true);
+  channel_config_set_ring(&d, true, EDGE_CAPTURE_RING_BITS);
+  channel_config_set_dreq(&d, pio_get_dreq(pio, channel->sm, false));
+  dma_channel_configure(channel->dma_chan, &d, rings[channel - channels],
+                        &pio->rxf[channel->sm], UINT32_MAX, true);
+  pio_set_irq0_source_enabled(pio, pis_interrupt0 + channel->sm, true);
+}
+
+/**
+ * @brief Returns the current tick, estimated from the system timer.
+ *
+ * The estimate runs from the last record read, whose tick is exact, so its
+ * error is bounded by how late that record was read rather than growing
+ * with uptime. clock_get_hz keeps reporting the full clk_sys while
+ * power_idle_until slows it, which is the rate the ticks are kept at.
+ *
+ * @return The number of ticks since capture started.
+ */
+static uint64_t now_ticks() {
+  uint64_t elapsed_us = to_us_since_boot(get_absolute_time()) - anchor_us;
+  return anchor_ticks + elapsed_us * (clock_get_hz(clk_sys) / 1000000) /
+                            (EDGE_CAPTURE_CYCLES_PER_TICK *
+                             EDGE_CAPTURE_CLK_DIV);
+}
+
+/**
+ * @brief Converts a number of ticks to microseconds.
+ *
+ * @param ticks The number of ticks.
+ *
+ * @return The time in microseconds.
+ */
+static float ticks_to_us(uint64_t ticks) {
+  return (float)ticks * EDGE_CAPTURE_CYCLES_PER_TICK * EDGE_CAPTURE_CLK_DIV /
+         (clock_get_hz(clk_sys) / 1000000.0f);
+}
+
+/**
+ * @brief Updates the ALERT timing with a new ALERT pin state.
+ *
+ * @param ticks The tick of the edge.
+ * @param level The level of ALERT_GP.
+ *
+ * @return None.
+ */
+static void alert_edge(uint64_t ticks, bool level) {
+  bool is_asserted = level == alert_irq_is_active_high();
+  if (is_asserted && !alert_timing.is_asserted) {
+    alert_timing.assertions++;
+    alert_timing.asserted_at = ticks;
+  } else if (!is_asserted && alert_timing.is_asserted) {
+    uint64_t dwell = ticks - alert_timing.asserted_at;
+    alert_timing.asserted_ticks += dwell;
+    alert_timing.last_dwell_ticks = dwell;
+    if (dwell > alert_timing.max_dwell_ticks) {
+      alert_timing.max_dwell_ticks = dwell;
+    }
+  }
+  alert_timing.is_asserted = is_asserted;
+}
+
+/**
+ * @brief Reads the new records of one capture channel.
+ *
+ * The 32-bit tick of each record is widened against the current tick
+ * estimated from the previous record, which is exact as long as the
+ * estimate is off by less than 2^31 ticks. Each record read becomes the new
+ * estimate's starting point.
+ *
+ * @param index One of EDGE_CHANNELS.
+ *
+ * @return None.
+ */
+static void service_channel(uint index) {
+  EdgeChannel *channel = &channels[index];
+  stats_seq++;
+  __dmb();
+  uint32_t written =
+      UINT32_MAX - dma_channel_hw_addr(channel->dma_chan)->transfer_count;
+  if (written - channel->read_words > EDGE_RING_WORDS) {
+    uint32_t skipped = (written - EDGE_RING_WORDS + 1) & ~1u;
+    edge_stats.lost += (skipped - channel->read_words) / 2;
+    channel->read_words = skipped;
+  }
+  while (written - channel->read_words >= 2) {
+    uint32_t tick = -rings[index][channel->read_words % EDGE_RING_WORDS];
+    uint32_t pins = rings[index][(channel->read_words + 1) % EDGE_RING_WORDS];
+    channel->read_words += 2;
+    edge_stats.records++;
+    uint64_t now = now_ticks();
+    uint64_t ticks = now + (int32_t)(tick - (uint32_t)now);
+    anchor_ticks = ticks;
+    anchor_us = to_us_since_boot(get_absolute_time());
+    uint32_t changed = channel->has_state ? channel->pins ^ pins : 0;
+    if (index == EDGE_ALERT) {
+      alert_edge(ticks, pins & 1);
+    } else {
+      for (uint i = 0; i < EDGE_CAPTURE_BTN_PINS; i++) {
+        if (changed & (1u << i)) {
+          edge_stats.btn_edges[i]++;
+          edge_stats.btn_last_ticks[i] = ticks;
+        }
+      }
+    }
+    channel->pins = pins;
+    channel->has_state = true;
+  }
+  __dmb();
+  stats_seq++;
+}
+
+/**
+ * @brief Reads the edges captured by the state machines that raised their
+ * IRQ flag. Runs on core0 for every record, so the rings never fill up and
+ * core0 stays asleep while the pins are quiet.
+ *
+ * @return None.
+ */
+static void edge_capture_irq() {
+  PIO pio = EDGE_CAPTURE_PIO;
+  for (uint i = 0; i < NUMBER_OF_EDGE_CHANNELS; i++) {
+    if (pio_interrupt_get(pio, channels[i].sm)) {
+      pio_interrupt_clear(pio, channels[i].sm);
+      // The flag is raised as the record is pushed, a few cycles before the
+      // DMA has moved it into the ring.
+      while (!pio_sm_is_rx_fifo_empty(pio, channels[i].sm)) {
+        tight_loop_contents();
+      }
+      service_channel(i);
+    }
+  }
+}
+
+/**
+ * @brief Starts timestamping edges on the button pins and ALERT_GP.
+ *
+ * Two state machines of EDGE_CAPTURE_PIO sample the pins, since the I2C0
+ * pins sit between the buttons and ALERT_GP and would flood the FIFO with
+ * bus traffic. Each one is drained by its own DMA channel into a ring, and
+ * raises EDGE_CAPTURE_IRQ on core0 after each record to have it read. Both
+ * state machines are started in the same cycle and share one tick count.
+ *
+ * @return None.
+ */
+void edge_capture_init() {
+  init_channel(&channels[EDGE_BTNS], EDGE_CAPTURE_BTN_BASE,
+               EDGE_CAPTURE_BTN_PINS);
+  init_channel(&channels[EDGE_ALERT], ALERT_GP, 1);
+  irq_set_exclusive_handler(EDGE_CAPTURE_IRQ, edge_capture_irq);
+  irq_set_enabled(EDGE_CAPTURE_IRQ, true);
+  anchor_us = to_us_since_boot(get_absolute_time());
+  pio_enable_sm_mask_in_sync(EDGE_CAPTURE_PIO,
+                             (1u << channels[EDGE_BTNS].sm) |
+                                 (1u << channels[EDGE_ALERT].sm));
+  is_started = true;
+}
+
+/**
+ * @brief Keeps the tick rate constant while clk_sys is divided down. Must
+ * be called on core0 right after every change of the clk_sys divider.
+ *
+ * @param div The integer divider clk_sys now runs at, 1 or
+ * POWER_IDLE_CLK_DIV.
+ *
+ * @return None.
+ */
+void edge_capture_clk_sys_divided(uint div) {
+  if (!is_started) {
+    return;
+  }
+  for (uint i = 0; i < NUMBER_OF_EDGE_CHANNELS; i++) {
+    pio_sm_set_clkdiv_int_frac(EDGE_CAPTURE_PIO, channels[i].sm,
+                               EDGE_CAPTURE_CLK_DIV / div, 0);
+  }
+}
+
+/**
+ * @brief Prints the over-temperature duty cycle, the ALERT dwell times and
+ * the button edge counts to the console.
+ *
+ * The statistics are copied first, and copied again if the copy overlapped
+ * an update on core0, so the figures printed belong together.
+ *
+ * @return None.
+ */
+void print_edge_stats() {
+  AlertTiming timing;
+  EdgeStats stats;
+  uint64_t now;
+  uint32_t seq;
+  do {
+    while ((seq = stats_seq) & 1) {
+      tight_loop_contents();
+    }
+    __dmb();
+    timing = alert_timing;
+    stats = edge_stats;
+    now = now_ticks();
+    __dmb();
+  } while (stats_seq != seq);
+
+  uint64_t asserted = timing.asserted_ticks;
+  if (timing.is_asserted) {
+    asserted += now - timing.asserted_at;
+  }
+  printf("\nEdge capture: %lu records, %lu lost, %.3f us per tick\n",
+         (unsigned long)stats.records, (unsigned long)stats.lost,
+         ticks_to_us(1));
+  printf("ALERT: %lu assertions, duty %.3f%%, dwell last %.3f ms, max %.3f "
+         "ms%s\n",
+         (unsigned long)timing.assertions,
+         now ? 100.0f * (float)asserted / (float)now : 0.0f,
+         ticks_to_us(timing.last_dwell_ticks) / 1000.0f,
+         ticks_to_us(timing.max_dwell_ticks) / 1000.0f,
+         timing.is_asserted ? ", asserted now" : "");
+  for (uint i = 0; i < EDGE_CAPTURE_BTN_PINS; i++) {
+    printf("GP%u: %lu edges, last at %.3f us\n", EDGE_CAPTURE_BTN_BASE + i,
+           (unsigned long)stats.btn_edges[i],
+           ticks_to_us(stats.btn_last_ticks[i]));
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef __EDGE_CAPTURE_H__
+#define __EDGE_CAPTURE_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the ALERT timing measured from captured edges, in ticks
+// of the state machines since capture started
+// assertions the number of times ALERT was asserted
+// asserted_ticks the total time of the completed assertions
+// asserted_at the tick of the current assertion, valid while is_asserted
+// last_dwell_ticks how long the last completed assertion lasted
+// max_dwell_ticks the longest completed assertion
+// is_asserted whether ALERT is currently asserted
+typedef struct {
+  uint32_t assertions;
+  uint64_t asserted_ticks;
+  uint64_t asserted_at;
+  uint64_t last_dwell_ticks;
+  uint64_t max_dwell_ticks;
+  bool is_asserted;
+} AlertTiming;
+
+// Struct for storing edge capture statistics
+// records the number of edge records read from the DMA rings
+// lost the number of records overwritten before they were read
+// btn_edges the number of edges seen on each button pin, from BTN4 up
+// btn_last_ticks the tick of the last edge of each button pin
+typedef struct {
+  uint32_t records;
+  uint32_t lost;
+  uint32_t btn_edges[EDGE_CAPTURE_BTN_PINS];
+  uint64_t btn_last_ticks[EDGE_CAPTURE_BTN_PINS];
+} EdgeStats;
+
+void edge_capture_init();
+void edge_capture_clk_sys_divided(uint div);
+void print_edge_stats();
+
+#endif
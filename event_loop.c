@@ -0,0 +1,189 @@
+#include "event_loop.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "flash_util.h"
+#include "gpio_util.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "power.h"
+
+// Post times of the requests in flight, indexed by request count. The FIFO
+// holds 8 words, so 16 slots cover every queued request plus one blocked
+// poster.
+#define POST_SLOTS 16
+
+static volatile uint64_t post_us[POST_SLOTS];
+static volatile uint32_t posted = 0;
+static uint32_t handled = 0;
+static EventLoopStats loop_stats = {0};
+static Task *loop_tasks = NULL;
+static size_t loop_len = 0;
+static uint64_t start_us = 0;
+// The function of the CALL_CORE0 request in flight, and its result.
+static core0_call_fn_t call_fn = NULL;
+static const void *call_ctx = NULL;
+static volatile bool call_result = false;
+static volatile bool is_call_done = false;
+
+/**
+ * @brief Sends a request to core0 and records when it was sent.
+ *
+ * This function must be called from core1. The FIFO push wakes core0 if it
+ * is waiting for an event.
+ *
+ * @param request One of DISABLE_IRQ, ENABLE_IRQ, PARK_CORE or CALL_CORE0.
+ *
+ * @return None.
+ */
+void event_loop_post(uint32_t request) {
+  post_us[posted % POST_SLOTS] = to_us_since_boot(get_absolute_time());
+  __dmb();
+  posted++;
+  multicore_fifo_push_blocking(request);
+}
+
+/**
+ * @brief Runs a function on core0 between two tasks and waits for it.
+ *
+ * Settings that the sampling core reads without locks are changed this way,
+ * so a change never lands in the middle of a sampling pass. This function
+ * must be called from core1, which is the only caller, so one call is in
+ * flight at a time.
+ *
+ * @param fn The function to run.
+ * @param ctx The argument passed to fn, which must stay valid until the
+ * call returns.
+ *
+ * @return The value fn returned.
+ */
+bool event_loop_call(core0_call_fn_t fn, const void *ctx) {
+  call_fn = fn;
+  call_ctx = ctx;
+  is_call_done = false;
+  event_loop_post(CALL_CORE0);
+  while (!is_call_done) {
+    __wfe();
+  }
+  __dmb();
+  return call_result;
+}
+
+/**
+ * @brief Handles every request waiting in the FIFO from core1.
+ *
+ * @return None.
+ */
+static void handle_requests() {
+  while (multicore_fifo_rvalid()) {
+    uint32_t request = multicore_fifo_pop_blocking();
+    uint64_t now_us = to_us_since_boot(get_absolute_time());
+    uint32_t latency_us = (uint32_t)(now_us - post_us[handled % POST_SLOTS]);
+    handled++;
+    loop_stats.requests++;
+    loop_stats.last_latency_us = latency_us;
+    loop_stats.total_latency_us += latency_us;
+    if (latency_us > loop_stats.max_latency_us) {
+      loop_stats.max_latency_us = latency_us;
+    }
+
+    if (request == DISABLE_IRQ) {
+      disable_irq(proj_gpio, NUMBER_OF_GPIOS);
+    } else if (request == ENABLE_IRQ) {
+      enable_irq(proj_gpio, NUMBER_OF_GPIOS);
+    } else if (request == PARK_CORE) {
+      // Core1 is about to write flash; stay out of it until it is done.
+      park_core();
+    } else if (request == CALL_CORE0) {
+      call_result = call_fn(call_ctx);
+      __dmb();
+      is_call_done = true;
+      __sev();
+    }
+  }
+}
+
+/**
+ * @brief Runs the core0 event loop forever.
+ *
+ * Every pass handles the requests from core1, then runs each task whose
+ * deadline has been reached or whose event check is true. Tasks run to
+ * completion in order, so they never need locks against each other. The
+ * core then waits in power_idle_until for the earliest deadline; GPIO
+ * interrupts and the FIFO push of event_loop_post both wake it early. Time
+ * spent waiting is counted as idle time.
+ *
+ * @param tasks The tasks to run; their next fields give the first deadlines.
+ * @param len The number of tasks.
+ *
+ * @return Never returns.
+ */
+void event_loop_run(Task *tasks, size_t len) {
+  loop_tasks = tasks;
+  loop_len = len;
+  start_us = to_us_since_boot(get_absolute_time());
+
+  while (1) {
+    handle_requests();
+
+    absolute_time_t wake = at_the_end_of_time;
+    bool is_busy = false;
+    for (size_t i = 0; i < len; i++) {
+      Task *task = &tasks[i];
+      absolute_time_t now = get_absolute_time();
+      if (time_reached(task->next) || (task->is_ready && task->is_ready())) {
+        task->next = task->run(now);
+        uint32_t elapsed_us =
+            (uint32_t)absolute_time_diff_us(now, get_absolute_time());
+        task->runs++;
+        if (elapsed_us > task->max_us) {
+          task->max_us = elapsed_us;
+        }
+        // A task may have made another one ready, or a request may have
+        // arrived, so check again before waiting.
+        is_busy = true;
+      }
+      if (absolute_time_diff_us(task->next, wake) > 0) {
+        wake = task->next;
+      }
+    }
+    if (is_busy || multicore_fifo_rvalid()) {
+      continue;
+    }
+
+    absolute_time_t idle_start = get_absolute_time();
+    power_idle_until(wake);
+    loop_stats.idle_us +=
+        absolute_time_diff_us(idle_start, get_absolute_time());
+    loop_stats.wakeups++;
+  }
+}
+
+/**
+ * @brief Prints the task, request latency and idle statistics of the event
+ * loop to the console.
+ *
+ * @return None.
+ */
+void print_event_loop_stats() {
+  uint64_t uptime_us = to_us_since_boot(get_absolute_time()) - start_us;
+  if (loop_tasks == NULL || uptime_us == 0) {
+    return;
+  }
+  for (size_t i = 0; i < loop_len; i++) {
+    printf("Task %-10s %8lu runs, max %lu us\n", loop_tasks[i].name,
+           (unsigned long)loop_tasks[i].runs,
+           (unsigned long)loop_tasks[i].max_us);
+  }
+  printf("Requests: %lu, latency last %lu us, mean %lu us, max %lu us\n",
+         (unsigned long)loop_stats.requests,
+         (unsigned long)loop_stats.last_latency_us,
+         (unsigned long)(loop_stats.requests
+                             ? loop_stats.total_latency_us / loop_stats.requests
+                             : 0),
+         (unsigned long)loop_stats.max_latency_us);
+  printf("core0 idle: %.2f%% (%lu wakeups)\n",
+         100.0f * (float)loop_stats.idle_us / (float)uptime_us,
+         (unsigned long)loop_stats.wakeups);
+}
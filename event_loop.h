@@ -0,0 +1,50 @@
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+#include "pico/stdlib.h"
+
+// A task runs when its deadline is reached or its is_ready check returns
+// true, and returns the time it wants to run next.
+typedef absolute_time_t (*task_fn_t)(absolute_time_t now);
+typedef bool (*task_ready_fn_t)();
+// A function core1 runs on core0 with event_loop_call.
+typedef bool (*core0_call_fn_t)(const void *ctx);
+
+// Struct for storing one cooperative task of the core0 event loop
+// name the name printed in the statistics
+// run the task body; it must not block
+// is_ready an optional event check, NULL for a timer-only task
+// next the deadline of the next run
+// runs the number of runs
+// max_us the longest run
+typedef struct {
+  const char *name;
+  task_fn_t run;
+  task_ready_fn_t is_ready;
+  absolute_time_t next;
+  uint32_t runs;
+  uint32_t max_us;
+} Task;
+
+// Struct for storing event loop statistics
+// requests the number of FIFO requests handled
+// last_latency_us the time from the last post to its handling
+// max_latency_us the longest time from a post to its handling
+// total_latency_us the sum of all post-to-handling times
+// idle_us the total time spent waiting for a deadline or event
+// wakeups the number of times the wait returned
+typedef struct {
+  uint32_t requests;
+  uint32_t last_latency_us;
+  uint32_t max_latency_us;
+  uint64_t total_latency_us;
+  uint64_t idle_us;
+  uint32_t wakeups;
+} EventLoopStats;
+
+void event_loop_post(uint32_t request);
+bool event_loop_call(core0_call_fn_t fn, const void *ctx);
+void event_loop_run(Task *tasks, size_t len);
+void print_event_loop_stats();
+
+#endif
@@ -0,0 +1,88 @@
+#include "event_queue.h"
+
+#include <stdio.h>
+
+#include "hardware/sync.h"
+
+static const char *const event_names[] = {"normal", "warning", "critical",
+                                          "rising", "falling", "captured"};
+
+// Single-producer, single-consumer ring; one slot is kept free to tell a
+// full ring from an empty one.
+static Event events[EVENT_QUEUE_LEN];
+static volatile uint head = 0;
+static volatile uint tail = 0;
+static uint32_t dropped = 0;
+
+/**
+ * @brief Appends an event to the event stream.
+ *
+ * @param type One of EVENT_TYPES.
+ * @param sensor The proj_sensors index of the sensor.
+ * @param timestamp_ms The time of the sample that caused the event.
+ * @param value The register value that caused the event.
+ *
+ * @return true if the event was queued, false if the queue is full and the
+ * event was dropped.
+ */
+bool event_push(uint8_t type, uint8_t sensor, uint32_t timestamp_ms,
+                int16_t value) {
+  uint next = (head + 1) % EVENT_QUEUE_LEN;
+  if (next == tail) {
+    dropped++;
+    return false;
+  }
+  events[head] = (Event){.timestamp_ms = timestamp_ms,
+                         .type = type,
+                         .sensor = sensor,
+                         .value = value};
+  __dmb();
+  head = next;
+  return true;
+}
+
+/**
+ * @brief Removes the oldest event from the event stream.
+ *
+ * @param event A pointer that receives the event.
+ *
+ * @return true if an event was removed, false if the queue is empty.
+ */
+bool event_pop(Event *event) {
+  if (tail == head) {
+    return false;
+  }
+  __dmb();
+  *event = events[tail];
+  tail = (tail + 1) % EVENT_QUEUE_LEN;
+  return true;
+}
+
+/**
+ * @brief Returns whether the event stream holds any events.
+ *
+ * @return true if event_pop would succeed.
+ */
+bool event_pending() { return tail != head; }
+
+/**
+ * @brief Drains the event stream to the console.
+ *
+ * @return None.
+ */
+void print_events() {
+  Event event;
+  while (event_pop(&event)) {
+    printf("[EVENT] %lu ms sensor %u %s %.4f %s\n",
+           (unsigned long)event.timestamp_ms, event.sensor,
+           event_names[event.type], event.value / 256.0f,
+           (event.type == EVENT_TREND_RISING ||
+            event.type == EVENT_TREND_FALLING)
+               ? "C/min"
+               : "C");
+  }
+  if (dropped != 0) {
+    printf("[WARNING] %lu events dropped\n", (unsigned long)dropped);
+    dropped = 0;
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef __EVENT_QUEUE_H__
+#define __EVENT_QUEUE_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+enum EVENT_TYPES {
+  EVENT_ALERT_NORMAL,
+  EVENT_ALERT_WARNING,
+  EVENT_ALERT_CRITICAL,
+  EVENT_TREND_RISING,
+  EVENT_TREND_FALLING,
+  EVENT_ALERT_CAPTURE,
+};
+
+// Struct for storing one event of the event stream
+// timestamp_ms the time of the sample that caused the event
+// type one of EVENT_TYPES
+// sensor the proj_sensors index of the sensor
+// value the register value that caused the event, or the rate of change in
+// 1/256 C per minute for trend events
+typedef struct {
+  uint32_t timestamp_ms;
+  uint8_t type;
+  uint8_t sensor;
+  int16_t value;
+} Event;
+
+bool event_push(uint8_t type, uint8_t sensor, uint32_t timestamp_ms,
+                int16_t value);
+bool event_pop(Event *event);
+bool event_pending();
+void print_events();
+
+#endif
@@ -0,0 +1,127 @@
+#include "fast_boot.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "console.h"
+#include "pico/stdio_usb.h"
+#include "sample_log.h"
+
+static LogRecord boot_buffer[FAST_BOOT_BUFFER_LEN];
+static BootTimes boot_times = {0};
+static volatile bool is_capturing = true;
+// Number of buffered samples already printed, or -1 before the CSV header.
+static int32_t flushed = -1;
+
+/**
+ * @brief Returns whether samples are still being held for the host.
+ *
+ * Capture lasts from reset until a host connects or a button is pressed,
+ * whichever comes first. The sensors are sampled throughout, even though
+ * BTN4 has not enabled reading, so that the host sees the readings since
+ * reset.
+ *
+ * @return true while samples go to the boot buffer instead of the console.
+ */
+bool fast_boot_is_capturing() { return is_capturing; }
+
+/**
+ * @brief Ends boot capture without waiting for a host, so that a menu opened
+ * with a button owns the sensor buses. It is safe to call from an interrupt.
+ *
+ * @return None.
+ */
+void fast_boot_cancel() { is_capturing = false; }
+
+/**
+ * @brief Stores the valid samples of a sampling pass in the boot buffer.
+ *
+ * The first call records the boot-to-first-sample time. Samples beyond
+ * FAST_BOOT_BUFFER_LEN are counted and dropped, keeping the oldest ones.
+ *
+ * @param samples The latest sample of every sensor.
+ * @param len The number of samples.
+ * @param valid_mask The bit mask of samples that hold a new reading.
+ *
+ * @return None.
+ */
+void fast_boot_record(const SensorSample *samples, size_t len,
+                      uint32_t valid_mask) {
+  if (boot_times.first_sample_us == 0) {
+    boot_times.first_sample_us = to_us_since_boot(get_absolute_time());
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (!(valid_mask & (1u << i))) {
+      continue;
+    }
+    if (boot_times.buffered == FAST_BOOT_BUFFER_LEN) {
+      boot_times.dropped++;
+      continue;
+    }
+    boot_buffer[boot_times.buffered++] = (LogRecord){
+        .timestamp_ms = to_ms_since_boot(samples[i].timestamp),
+        .sensor = i,
+        .flags = 0xFF,
+        .raw = samples[i].raw};
+  }
+}
+
+/**
+ * @brief Checks whether a host has opened the USB serial port and records
+ * the boot-to-USB-ready time the first time it has.
+ *
+ * @return true once the host is connected.
+ */
+bool fast_boot_usb_ready() {
+  if (boot_times.usb_ready_us != 0) {
+    return true;
+  }
+  if (!stdio_usb_connected()) {
+    return false;
+  }
+  boot_times.usb_ready_us = to_us_since_boot(get_absolute_time());
+  return true;
+}
+
+/**
+ * @brief Prints the buffered samples as CSV, followed by the boot times, and
+ * then ends boot capture.
+ *
+ * The CSV is longer than the console buffer, so each call only prints the
+ * rows that fit and the rest is left for the next call. Samples taken in
+ * the meantime are still buffered and printed with the others.
+ *
+ * @return true once every sample and the boot times have been printed.
+ */
+bool fast_boot_flush() {
+  if (flushed < 0) {
+    printf("sensor,timestamp_ms,temp_c\n");
+    flushed = 0;
+  }
+  while ((uint32_t)flushed < boot_times.buffered) {
+    if (console_space() < FAST_BOOT_CSV_LINE_BYTES) {
+      return false;
+    }
+    printf("%u,%lu,%.4f\n", boot_buffer[flushed].sensor,
+           (unsigned long)boot_buffer[flushed].timestamp_ms,
+           (int16_t)boot_buffer[flushed].raw / 256.0f);
+    flushed++;
+  }
+  is_capturing = false;
+  print_boot_times();
+  return true;
+}
+
+/**
+ * @brief Prints the boot milestones to the console.
+ *
+ * @return None.
+ */
+void print_boot_times() {
+  printf("Boot: first sample %lu us, USB ready %lu us, %lu buffered, %lu "
+         "dropped\n",
+         (unsigned long)boot_times.first_sample_us,
+         (unsigned long)boot_times.usb_ready_us,
+         (unsigned long)boot_times.buffered,
+         (unsigned long)boot_times.dropped);
+}
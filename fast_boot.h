@@ -0,0 +1,27 @@
+#ifndef __FAST_BOOT_H__
+#define __FAST_BOOT_H__
+
+#include "pico/stdlib.h"
+#include "sensor_poll.h"
+
+// Struct for storing boot milestones, in microseconds since reset
+// first_sample_us the time the first sample completed
+// usb_ready_us the time a host first opened the USB serial port, 0 until then
+// buffered the number of samples taken before the host connected
+// dropped the number of samples that did not fit in the boot buffer
+typedef struct {
+  uint64_t first_sample_us;
+  uint64_t usb_ready_us;
+  uint32_t buffered;
+  uint32_t dropped;
+} BootTimes;
+
+bool fast_boot_is_capturing();
+void fast_boot_cancel();
+void fast_boot_record(const SensorSample *samples, size_t len,
+                      uint32_t valid_mask);
+bool fast_boot_usb_ready();
+bool fast_boot_flush();
+void print_boot_times();
+
+#endif
@@ -0,0 +1,143 @@
+#include "filter.h"
+
+#include <stdio.h>
+
+static const char *const filter_names[] = {"none", "ema", "boxcar", "median"};
+
+static SensorFilter filters[NUMBER_OF_SENSORS];
+
+/**
+ * @brief Selects the filter of a sensor and clears its state.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param type One of FILTER_TYPES.
+ * @param param The smoothing shift of FILTER_EMA, 1 to FILTER_MAX_EMA_SHIFT,
+ * or the window length of FILTER_BOXCAR, 1 to FILTER_MAX_WINDOW, or of
+ * FILTER_MEDIAN, odd and up to FILTER_MAX_WINDOW.
+ *
+ * @return true if the filter was changed, false if the arguments are invalid.
+ */
+bool filter_configure(uint8_t sensor, uint8_t type, uint8_t param) {
+  if (sensor >= NUMBER_OF_SENSORS) {
+    return false;
+  }
+  if ((type == FILTER_EMA && (param < 1 || param > FILTER_MAX_EMA_SHIFT)) ||
+      (type == FILTER_BOXCAR && (param < 1 || param > FILTER_MAX_WINDOW)) ||
+      (type == FILTER_MEDIAN &&
+       (param < 1 || param > FILTER_MAX_WINDOW || (param & 1) == 0)) ||
+      type > FILTER_MEDIAN) {
+    return false;
+  }
+  SensorFilter *f = &filters[sensor];
+  f->type = type;
+  f->param = param;
+  f->head = 0;
+  f->len = 0;
+  f->sum = 0;
+  return true;
+}
+
+/**
+ * @brief Returns the filter type of a sensor.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ *
+ * @return One of FILTER_TYPES.
+ */
+uint8_t filter_type(uint8_t sensor) {
+  return sensor < NUMBER_OF_SENSORS ? filters[sensor].type : FILTER_NONE;
+}
+
+/**
+ * @brief Returns the median of a window with an insertion sort of a copy.
+ *
+ * The window is at most FILTER_MAX_WINDOW values, so the sort is bounded by
+ * FILTER_MAX_WINDOW^2 / 2 compares.
+ *
+ * @param window The values.
+ * @param len The number of values, odd.
+ *
+ * @return The middle value.
+ */
+static int16_t HOT_PATH_FUNC(window_median)(const int16_t *window,
+                                            uint8_t len) {
+  int16_t sorted[FILTER_MAX_WINDOW];
+  for (uint8_t i = 0; i < len; i++) {
+    int16_t value = window[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[len / 2];
+}
+
+/**
+ * @brief Runs one sample through the filter of a sensor.
+ *
+ * All filters use integer arithmetic only. The exponential moving average
+ * keeps 8 fractional bits so that one-LSB steps are not lost to truncation,
+ * the boxcar keeps a running sum, and the median sorts a copy of at most
+ * FILTER_MAX_WINDOW values, which bounds the cost of a call. Until a window
+ * is full, the boxcar and median work on the values seen so far.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param raw The ambient temperature register.
+ *
+ * @return The filtered register value, or raw if the sensor has no filter.
+ */
+int16_t HOT_PATH_FUNC(filter_sample)(uint8_t sensor, int16_t raw) {
+  if (sensor >= NUMBER_OF_SENSORS) {
+    return raw;
+  }
+  SensorFilter *f = &filters[sensor];
+
+  if (f->type == FILTER_EMA) {
+    if (f->len == 0) {
+      f->ema = (int32_t)raw << 8;
+      f->len = 1;
+    } else {
+      f->ema += (((int32_t)raw << 8) - f->ema) >> f->param;
+    }
+    return (int16_t)((f->ema + (1 << 7)) >> 8);
+  }
+  if (f->type != FILTER_BOXCAR && f->type != FILTER_MEDIAN) {
+    return raw;
+  }
+
+  if (f->len == f->param) {
+    f->sum -= f->window[f->head];
+  } else {
+    f->len++;
+  }
+  f->window[f->head] = raw;
+  f->sum += raw;
+  f->head = (f->head + 1) % f->param;
+
+  if (f->type == FILTER_BOXCAR) {
+    return (int16_t)(f->sum / f->len);
+  }
+  // An even count only occurs while the window fills, when the values are
+  // still in order, so the oldest one is left out.
+  if ((f->len & 1) == 0) {
+    return window_median(&f->window[1], f->len - 1);
+  }
+  return window_median(f->window, f->len);
+}
+
+/**
+ * @brief Prints the filter of every sensor to the console.
+ *
+ * @return None.
+ */
+void print_filters() {
+  for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+    printf("Sensor %d filter: %s", s, filter_names[filters[s].type]);
+    if (filters[s].type != FILTER_NONE) {
+      printf(" (%u)", filters[s].param);
+    }
+    printf("\n");
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef __FILTER_H__
+#define __FILTER_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+enum FILTER_TYPES {
+  FILTER_NONE = 0,
+  FILTER_EMA = 1,    // param is the smoothing shift, alpha = 1 / 2^param
+  FILTER_BOXCAR = 2, // param is the window length
+  FILTER_MEDIAN = 3, // param is the window length, odd
+};
+
+// Struct for storing the filter of one sensor
+// type one of FILTER_TYPES
+// param the shift or window length of the filter
+// window the most recent register values, oldest at head once full
+// head the index the next value is written to
+// len the number of valid values in window
+// sum the sum of the values in window
+// ema the exponential moving average, with 8 fractional bits
+typedef struct {
+  uint8_t type;
+  uint8_t param;
+  int16_t window[FILTER_MAX_WINDOW];
+  uint8_t head;
+  uint8_t len;
+  int32_t sum;
+  int32_t ema;
+} SensorFilter;
+
+bool filter_configure(uint8_t sensor, uint8_t type, uint8_t param);
+uint8_t filter_type(uint8_t sensor);
+int16_t filter_sample(uint8_t sensor, int16_t raw);
+void print_filters();
+
+#endif
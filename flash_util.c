@@ -0,0 +1,154 @@
+#include "flash_util.h"
+
+#include "config.h"
+#include "event_loop.h"
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+
+// Handshake between the core writing flash and the core parked in RAM.
+static volatile bool is_parked = false;
+static volatile bool is_park_released = false;
+
+/**
+ * @brief Parks the calling core in RAM until a flash write completes.
+ *
+ * This function is called by a core when it pops a PARK_CORE request from its
+ * multicore FIFO. It disables interrupts, signals that it is parked, and spins
+ * from SRAM so it does not fetch from flash while the other core erases or
+ * programs it.
+ *
+ * @return None.
+ */
+void __not_in_flash_func(park_core)() {
+  uint32_t irq_state = save_and_disable_interrupts();
+  is_parked = true;
+  while (!is_park_released) {
+  }
+  is_parked = false;
+  restore_interrupts(irq_state);
+}
+
+/**
+ * @brief Parks core0 and disables interrupts before a flash operation.
+ *
+ * @return The saved interrupt state to pass to end_flash_op.
+ */
+static uint32_t begin_flash_op() {
+  is_park_released = false;
+  event_loop_post(PARK_CORE);
+  while (!is_parked) {
+  }
+  return save_and_disable_interrupts();
+}
+
+/**
+ * @brief Restores interrupts and releases core0 after a flash operation.
+ *
+ * @param irq_state The interrupt state returned by begin_flash_op.
+ *
+ * @return None.
+ */
+static void end_flash_op(uint32_t irq_state) {
+  restore_interrupts(irq_state);
+  is_park_released = true;
+}
+
+/**
+ * @brief Erases flash sectors while core0 is parked.
+ *
+ * This function must be called from core1, since core0 is the core that
+ * services PARK_CORE requests.
+ *
+ * @param flash_offset The sector-aligned offset from the start of flash.
+ * @param len The number of bytes to erase, a multiple of FLASH_SECTOR_SIZE.
+ *
+ * @return None.
+ */
+void flash_safe_erase(uint32_t flash_offset, size_t len) {
+  uint32_t irq_state = begin_flash_op();
+  flash_range_erase(flash_offset, len);
+  end_flash_op(irq_state);
+}
+
+/**
+ * @brief Programs erased flash pages while core0 is parked.
+ *
+ * This function must be called from core1, since core0 is the core that
+ * services PARK_CORE requests.
+ *
+ * @param flash_offset The page-aligned offset from the start of flash.
+ * @param data A pointer to the data to program.
+ * @param len The number of bytes to program, a multiple of FLASH_PAGE_SIZE.
+ *
+ * @return None.
+ */
+void flash_safe_program(uint32_t flash_offset, const uint8_t *data,
+                        size_t len) {
+  uint32_t irq_state = begin_flash_op();
+  flash_range_program(flash_offset, data, len);
+  end_flash_op(irq_state);
+}
+
+/**
+ * @brief Erases and programs whole flash sectors while core0 is parked.
+ *
+ * This function erases the sectors covering len bytes at flash_offset and
+ * programs the data padded to a whole page, both under a single park of
+ * core0. It must be called from core1, since core0 is the core that services
+ * PARK_CORE requests.
+ *
+ * @param flash_offset The sector-aligned offset from the start of flash.
+ * @param data A pointer to the data to program. Its buffer must be readable
+ * up to the next FLASH_PAGE_SIZE boundary.
+ * @param len The number of bytes to program.
+ *
+ * @return true if the data was programmed, false if the offset is not sector
+ * aligned.
+ */
+bool flash_safe_write(uint32_t flash_offset, const uint8_t *data, size_t len) {
+  if (flash_offset % FLASH_SECTOR_SIZE != 0) {
+    return false;
+  }
+  size_t erase_len =
+      (len + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+  size_t program_len =
+      (len + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+
+  uint32_t irq_state = begin_flash_op();
+  flash_range_erase(flash_offset, erase_len);
+  flash_range_program(flash_offset, data, program_len);
+  end_flash_op(irq_state);
+  return true;
+}
+
+/**
+ * @brief Returns a pointer to flash contents through the XIP window.
+ *
+ * @param flash_offset The offset from the start of flash.
+ *
+ * @return A pointer to the memory-mapped flash contents.
+ */
+const uint8_t *flash_contents(uint32_t flash_offset) {
+  return (const uint8_t *)(uintptr_t)(XIP_BASE + flash_offset);
+}
+
+/**
+ * @brief Computes the CRC-32 (IEEE 802.3) of a buffer.
+ *
+ * @param data A pointer to the data.
+ * @param len The number of bytes of data.
+ *
+ * @return The CRC-32 of the data.
+ */
+uint32_t crc32(const uint8_t *data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
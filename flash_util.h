@@ -0,0 +1,14 @@
+#ifndef __FLASH_UTIL_H__
+#define __FLASH_UTIL_H__
+
+#include "pico/stdlib.h"
+
+void park_core();
+void flash_safe_erase(uint32_t flash_offset, size_t len);
+void flash_safe_program(uint32_t flash_offset, const uint8_t *data,
+                        size_t len);
+bool flash_safe_write(uint32_t flash_offset, const uint8_t *data, size_t len);
+const uint8_t *flash_contents(uint32_t flash_offset);
+uint32_t crc32(const uint8_t *data, size_t len);
+
+#endif
@@ -14,6 +14,9 @@ extern bool enable_read_temp;
 extern i2c_inst_t *i2c;
 // declare 8-bit integer variable dev_addr without defining it
 extern uint8_t dev_addr;
+// declare the sampling period and the bit mask of sampled sensors
+extern uint32_t sample_interval_ms;
+extern uint32_t active_sensors;
 // declare an array of type BtnState called btns without defining it
 extern volatile BtnState btns[NUMBER_OF_BTNS];
 #endif // end of ifndef directive
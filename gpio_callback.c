@@ -1,7 +1,9 @@
 #include <stdio.h>
 
+#include "alert_irq.h"
 #include "config.h"
 #include "debounce.h"
+#include "fast_boot.h"
 #include "globals.h"
 #include "gpio_util.h"
 #include "hardware/gpio.h"
@@ -18,8 +20,9 @@
 @brief Callback function for GPIO interrupts on button presses
 This function handles the GPIO interrupt for button presses and debounces the
 input. It determines which button was pressed and performs the corresponding
-action, such as scanning the I2C bus or showing device information. The function
-keeps track of the button state and only triggers the
+action, such as scanning the I2C bus or showing device information. Edges on
+ALERT_GP are handed to alert_irq_edge, which defers the register read. The
+function keeps track of the button state and only triggers the
 action when the button is stable. If the button is unstable or the input is
 invalid, the function returns without taking any action.
 
@@ -28,10 +31,13 @@ invalid, the function returns without taking any action.
 GPIO_IRQ_EDGE_FALL)
 @return void
 */
-void gpio_callback(uint gpio, uint32_t events) {
+void HOT_PATH_FUNC(gpio_callback)(uint gpio, uint32_t events) {
     volatile BtnState *target_btn;
     uint32_t btn_action;
-    if (gpio == BTN0) {
+    if (gpio == ALERT_GP) {
+        alert_irq_edge(events);
+        return;
+    } else if (gpio == BTN0) {
         target_btn = &btns[0];
         btn_action = SCAN_I2C_BUS;
     } else if (gpio == BTN1) {
@@ -63,13 +69,19 @@ void gpio_callback(uint gpio, uint32_t events) {
     bool is_btn_stable = debounce(*target_btn);
 
     if (is_btn_stable) {
+        fast_boot_cancel();
         if (btn_action == SHOW_TEMP) {
             enable_read_temp = true;
             return;
         } else {
             enable_read_temp = false;
-            multicore_fifo_drain();
-            multicore_fifo_push_timeout_us(btn_action, 1000);
+            // Never drain here: this core's FIFO carries core1's requests,
+            // including the PARK_CORE handshake of a flash write. A press
+            // made while core1's FIFO is full is dropped instead, and core1
+            // skips presses that queued up behind a menu.
+            if (multicore_fifo_wready()) {
+                multicore_fifo_push_blocking(btn_action);
+            }
         }
     }
 }
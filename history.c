@@ -0,0 +1,300 @@
+#include "history.h"
+
+#include <stdio.h>
+
+#include "hardware/sync.h"
+
+// Bucket length of every rollup tier.
+static const uint32_t tier_period_ms[HISTORY_TIERS] = {1000, 60 * 1000,
+                                                       60 * 60 * 1000};
+static const char *const tier_names[HISTORY_TIERS] = {"1 s", "1 min", "1 h"};
+
+static HistoryRollup seconds[NUMBER_OF_SENSORS][HISTORY_SECONDS];
+static HistoryRollup minutes[NUMBER_OF_SENSORS][HISTORY_MINUTES];
+static HistoryRollup hours[NUMBER_OF_SENSORS][HISTORY_HOURS];
+static SensorHistory history[NUMBER_OF_SENSORS];
+
+/**
+ * @brief Sets up an empty rollup tier.
+ *
+ * @param tier A pointer to the tier.
+ * @param ring The storage of the closed buckets.
+ * @param capacity The number of entries in ring.
+ *
+ * @return None.
+ */
+static void init_tier(HistoryTier *tier, HistoryRollup *ring,
+                      uint16_t capacity) {
+  tier->ring = ring;
+  tier->capacity = capacity;
+  tier->head = 0;
+  tier->len = 0;
+  tier->open.count = 0;
+  tier->sum = 0;
+}
+
+/**
+ * @brief Clears the history of every sensor.
+ *
+ * @return None.
+ */
+void history_init() {
+  for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+    SensorHistory *h = &history[s];
+    h->head = 0;
+    h->used = 1;
+    h->blocks[0].len = 0;
+    h->seq = 0;
+    sample_encoder_init(&h->enc);
+    init_tier(&h->tiers[0], seconds[s], HISTORY_SECONDS);
+    init_tier(&h->tiers[1], minutes[s], HISTORY_MINUTES);
+    init_tier(&h->tiers[2], hours[s], HISTORY_HOURS);
+  }
+}
+
+/**
+ * @brief Adds a sample to a rollup tier, closing the open bucket first if the
+ * sample falls outside of it.
+ *
+ * @param tier A pointer to the tier.
+ * @param period_ms The bucket length of the tier.
+ * @param timestamp_ms The sample time in milliseconds since boot.
+ * @param value The register value.
+ *
+ * @return None.
+ */
+static void tier_add(HistoryTier *tier, uint32_t period_ms,
+                     uint32_t timestamp_ms, int16_t value) {
+  uint32_t start_ms = timestamp_ms - timestamp_ms % period_ms;
+  HistoryRollup *open = &tier->open;
+
+  if (open->count != 0 && open->start_ms != start_ms) {
+    open->mean = (int16_t)(tier->sum / open->count);
+    tier->ring[tier->head] = *open;
+    tier->head = (tier->head + 1) % tier->capacity;
+    if (tier->len < tier->capacity) {
+      tier->len++;
+    }
+    open->count = 0;
+  }
+  if (open->count == 0) {
+    open->start_ms = start_ms;
+    open->min = value;
+    open->max = value;
+    tier->sum = 0;
+  }
+  if (value < open->min) {
+    open->min = value;
+  }
+  if (value > open->max) {
+    open->max = value;
+  }
+  if (open->count < UINT16_MAX) {
+    tier->sum += value;
+    open->count++;
+  }
+}
+
+/**
+ * @brief Adds a sample to the raw tier and every rollup tier of a sensor.
+ *
+ * The cost is constant: one sample_encode call and one bucket update per
+ * tier. When the current raw block cannot hold another worst-case encoded
+ * sample, the next block is started with a fresh key frame, overwriting the
+ * oldest one. It must be called from the sampling core only. The update is
+ * bracketed by two increments of the history's seq, so the printers on core1
+ * can retry a copy that overlapped it.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param timestamp_ms The sample time in milliseconds since boot.
+ * @param raw The ambient temperature register.
+ *
+ * @return None.
+ */
+void history_append(uint8_t sensor, uint32_t timestamp_ms, uint16_t raw) {
+  if (sensor >= NUMBER_OF_SENSORS) {
+    return;
+  }
+  SensorHistory *h = &history[sensor];
+  h->seq++;
+  __dmb();
+  HistoryBlock *block = &h->blocks[h->head];
+
+  if (block->len + SAMPLE_CODEC_MAX_BYTES > HISTORY_BLOCK_BYTES) {
+    block->len += sample_encoder_flush(&h->enc, &block->bytes[block->len]);
+    h->head = (h->head + 1) % HISTORY_RAW_BLOCKS;
+    if (h->used < HISTORY_RAW_BLOCKS) {
+      h->used++;
+    }
+    block = &h->blocks[h->head];
+    block->len = 0;
+    sample_encoder_init(&h->enc);
+  }
+  block->len +=
+      sample_encode(&h->enc, timestamp_ms, raw, &block->bytes[block->len]);
+
+  for (int t = 0; t < HISTORY_TIERS; t++) {
+    tier_add(&h->tiers[t], tier_period_ms[t], timestamp_ms, (int16_t)raw);
+  }
+  __dmb();
+  h->seq++;
+}
+
+/**
+ * @brief Waits until no update of a sensor's history is in progress and
+ * starts a copy of it.
+ *
+ * @param h A pointer to the history.
+ *
+ * @return The sequence number to pass to copy_failed.
+ */
+static uint32_t copy_begin(const SensorHistory *h) {
+  uint32_t seq;
+  while ((seq = h->seq) & 1) {
+    tight_loop_contents();
+  }
+  __dmb();
+  return seq;
+}
+
+/**
+ * @brief Returns whether a copy started with copy_begin overlapped an update
+ * and must be taken again.
+ *
+ * @param h A pointer to the history.
+ * @param seq The sequence number returned by copy_begin.
+ *
+ * @return true if the history changed during the copy.
+ */
+static bool copy_failed(const SensorHistory *h, uint32_t seq) {
+  __dmb();
+  return h->seq != seq;
+}
+
+/**
+ * @brief Prints one decoded raw sample as a CSV row.
+ *
+ * @param ts The sample time in milliseconds since boot.
+ * @param raw The ambient temperature register.
+ * @param ctx A pointer to the sensor index.
+ *
+ * @return None.
+ */
+static void print_raw_sample(uint32_t ts, uint16_t raw, void *ctx) {
+  printf("%u,%lu,%.4f\n", *(const uint *)ctx, (unsigned long)ts,
+         (int16_t)raw / 256.0f);
+}
+
+/**
+ * @brief Prints the raw tier of a sensor, oldest sample first.
+ *
+ * Each block is copied before it is decoded, and the block being written is
+ * copied together with its encoder, whose pending run is then flushed into
+ * the copy so the live stream is not disturbed. A copy that overlapped a
+ * new sample is taken again.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ *
+ * @return None.
+ */
+static void print_raw_tier(uint sensor) {
+  const SensorHistory *h = &history[sensor];
+  SampleDecoder dec;
+  HistoryBlock block;
+  SampleEncoder enc;
+  bool is_last = false;
+  for (uint n = 0; !is_last; n++) {
+    uint32_t seq;
+    do {
+      seq = copy_begin(h);
+      uint used = h->used;
+      uint index =
+          (h->head + HISTORY_RAW_BLOCKS - used + 1 + n) % HISTORY_RAW_BLOCKS;
+      block = h->blocks[index];
+      is_last = n + 1 >= used;
+      if (is_last) {
+        enc = h->enc;
+      }
+    } while (copy_failed(h, seq));
+    sample_decoder_init(&dec);
+    sample_decode(&dec, block.bytes, block.len, print_raw_sample, &sensor);
+  }
+  uint8_t tail[SAMPLE_CODEC_MAX_BYTES];
+  size_t len = sample_encoder_flush(&enc, tail);
+  sample_decode(&dec, tail, len, print_raw_sample, &sensor);
+}
+
+/**
+ * @brief Prints one rollup bucket as a CSV row.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param rollup A pointer to the bucket.
+ *
+ * @return None.
+ */
+static void print_rollup(uint sensor, const HistoryRollup *rollup) {
+  printf("%u,%lu,%.4f,%.4f,%.4f,%u\n", sensor, (unsigned long)rollup->start_ms,
+         rollup->min / 256.0f, rollup->mean / 256.0f, rollup->max / 256.0f,
+         rollup->count);
+}
+
+/**
+ * @brief Prints a tier of every sensor's history to the console as CSV.
+ *
+ * Rollup tiers print the closed buckets oldest first, followed by the bucket
+ * that is still being filled, so the last day of trends takes a single
+ * request of at most HISTORY_HOURS + 1 rows per sensor. Every bucket is
+ * copied before it is printed and the copy is taken again if it overlapped a
+ * new sample, so a row never mixes values from two updates.
+ *
+ * @param tier HISTORY_RAW_TIER, or 1 + the index of a rollup tier.
+ *
+ * @return None.
+ */
+void print_history(uint tier) {
+  if (tier == HISTORY_RAW_TIER) {
+    printf("sensor,timestamp_ms,temp_c\n");
+    for (uint s = 0; s < NUMBER_OF_SENSORS; s++) {
+      print_raw_tier(s);
+    }
+    printf("Done.\n");
+    return;
+  }
+  if (tier > HISTORY_TIERS) {
+    return;
+  }
+
+  printf("# %s rollups\n", tier_names[tier - 1]);
+  printf("sensor,start_ms,min_c,mean_c,max_c,samples\n");
+  for (uint s = 0; s < NUMBER_OF_SENSORS; s++) {
+    const SensorHistory *h = &history[s];
+    const HistoryTier *t = &h->tiers[tier - 1];
+    HistoryRollup rollup;
+    uint32_t seq;
+    for (uint n = 0;; n++) {
+      bool is_closed;
+      do {
+        seq = copy_begin(h);
+        is_closed = n < t->len;
+        if (is_closed) {
+          rollup = t->ring[(t->head + t->capacity - t->len + n) % t->capacity];
+        }
+      } while (copy_failed(h, seq));
+      if (!is_closed) {
+        break;
+      }
+      print_rollup(s, &rollup);
+    }
+    int32_t sum;
+    do {
+      seq = copy_begin(h);
+      rollup = t->open;
+      sum = t->sum;
+    } while (copy_failed(h, seq));
+    if (rollup.count != 0) {
+      rollup.mean = (int16_t)(sum / rollup.count);
+      print_rollup(s, &rollup);
+    }
+  }
+  printf("Done.\n");
+}
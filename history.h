@@ -0,0 +1,71 @@
+#ifndef __HISTORY_H__
+#define __HISTORY_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+#include "sample_codec.h"
+
+// Index of the raw tier in history queries; rollup tiers follow it.
+#define HISTORY_RAW_TIER 0
+
+// Struct for storing one rollup bucket
+// start_ms the start of the bucket in milliseconds since boot
+// min the lowest register value in the bucket
+// mean the mean register value in the bucket
+// max the highest register value in the bucket
+// count the number of samples in the bucket
+typedef struct {
+  uint32_t start_ms;
+  int16_t min;
+  int16_t mean;
+  int16_t max;
+  uint16_t count;
+} HistoryRollup;
+
+// Struct for storing a rollup tier of one sensor
+// ring the closed buckets, oldest at head once the ring is full
+// capacity the number of entries in ring
+// head the index the next closed bucket is written to
+// len the number of valid entries in ring
+// open the bucket that is being filled, with mean holding nothing until it
+// is closed
+// sum the sum of the register values in the open bucket
+typedef struct {
+  HistoryRollup *ring;
+  uint16_t capacity;
+  uint16_t head;
+  uint16_t len;
+  HistoryRollup open;
+  int32_t sum;
+} HistoryTier;
+
+// Struct for storing one block of the compressed raw tier
+// bytes the encoded samples; every block starts with a key frame
+// len the number of valid bytes
+typedef struct {
+  uint8_t bytes[HISTORY_BLOCK_BYTES];
+  uint8_t len;
+} HistoryBlock;
+
+// Struct for storing the history of one sensor
+// blocks the raw tier, encoded with sample_encode, oldest at head once full
+// head the index of the block being written
+// used the number of blocks that hold samples
+// enc the encoder of the block being written
+// tiers the 1 s, 1 min and 1 h rollups
+// seq odd while history_append is updating the history, so readers on the
+// other core can detect a copy that overlapped an update
+typedef struct {
+  HistoryBlock blocks[HISTORY_RAW_BLOCKS];
+  uint8_t head;
+  uint8_t used;
+  SampleEncoder enc;
+  HistoryTier tiers[HISTORY_TIERS];
+  volatile uint32_t seq;
+} SensorHistory;
+
+void history_init();
+void history_append(uint8_t sensor, uint32_t timestamp_ms, uint16_t raw);
+void print_history(uint tier);
+
+#endif
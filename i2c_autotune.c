@@ -0,0 +1,153 @@
+#include "i2c_autotune.h"
+
+#include <limits.h>
+#include <stdio.h>
+
+#include "config.h"
+#include "sensor_driver.h"
+
+// Candidate bus clocks in Hz, slowest first. The first entry is the rate the
+// reference values are read at. Rates above a part's rating are skipped.
+static const uint autotune_rates[] = {100 * 1000, 200 * 1000, 400 * 1000,
+                                      600 * 1000, 800 * 1000, 1000 * 1000};
+
+// Registers read back at every rate. Every supported part has 16-bit limit
+// registers at these pointers, and reading them leaves ALERT alone.
+static const uint8_t autotune_regs[] = {TEMP_HYST_MIN_REG, TEMP_SET_MAX_REG};
+
+/**
+ * @brief Applies a baud rate to a hardware or PIO I2C bus.
+ *
+ * @param i2c_inst A pointer to the I2C instance, or NULL for a PIO bus.
+ * @param pio_bus A pointer to the PIO I2C bus when i2c_inst is NULL.
+ * @param baudrate The bus clock in Hz.
+ *
+ * @return None.
+ */
+static void set_bus_rate(i2c_inst_t *i2c_inst, PioI2C *pio_bus,
+                         uint baudrate) {
+  if (i2c_inst != NULL) {
+    i2c_set_bus_baudrate(i2c_inst, baudrate);
+  } else {
+    pio_i2c_set_baudrate(pio_bus, baudrate);
+  }
+}
+
+/**
+ * @brief Reads the check registers repeatedly and compares them with the
+ * values read at the slowest rate.
+ *
+ * @param sensor A pointer to the sensor to exercise.
+ * @param expected The values of autotune_regs read at autotune_rates[0].
+ *
+ * @return true if every read succeeded and matched, false otherwise.
+ */
+static bool verify_sensor(const SensorConfig *sensor,
+                          const uint16_t *expected) {
+  for (int trial = 0; trial < I2C_AUTOTUNE_TRIALS; trial++) {
+    for (size_t r = 0; r < count_of(autotune_regs); r++) {
+      uint16_t value;
+      if (sensor_driver_read_word(sensor, autotune_regs[r], &value) != 2 ||
+          value != expected[r]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the fastest reliable clock of one bus and applies it.
+ *
+ * This function reads the check registers of every responding sensor on the
+ * bus at the slowest rate, then steps the bus through autotune_rates up to
+ * the lowest rating of the parts found, reading the registers back at each
+ * step, and stops at the first rate where any sensor fails. Nothing is
+ * written to the sensors. If a rate failed, the fastest passing rate reduced
+ * by I2C_AUTOTUNE_MARGIN_PCT is applied to the bus; if every rate up to the
+ * rating passed, the fastest one is applied as is, since the rating already
+ * holds the margin. A bus with no responding sensors is left at
+ * TCN75A_BAUDRATE.
+ *
+ * This takes a few hundred ms per bus, so it only runs on demand or for a
+ * profile that asks for it. Saving a profile afterwards keeps the result.
+ *
+ * @param i2c_inst A pointer to the I2C instance, or NULL for a PIO bus.
+ * @param pio_bus A pointer to the PIO I2C bus when i2c_inst is NULL.
+ *
+ * @return The baud rate applied to the bus in Hz.
+ */
+uint autotune_bus(i2c_inst_t *i2c_inst, PioI2C *pio_bus) {
+  const SensorConfig *targets[NUMBER_OF_SENSORS];
+  uint16_t expected[NUMBER_OF_SENSORS][count_of(autotune_regs)];
+  uint max_rate = UINT_MAX;
+  size_t n = 0;
+
+  set_bus_rate(i2c_inst, pio_bus, autotune_rates[0]);
+  for (size_t i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const SensorConfig *sensor = &proj_sensors[i];
+    if (sensor->i2c_inst != i2c_inst ||
+        (i2c_inst == NULL && sensor->pio_bus != pio_bus)) {
+      continue;
+    }
+    bool is_present = true;
+    for (size_t r = 0; r < count_of(autotune_regs) && is_present; r++) {
+      is_present = sensor_driver_read_word(sensor, autotune_regs[r],
+                                           &expected[n][r]) == 2;
+    }
+    if (is_present) {
+      uint rating = sensor_driver_of(sensor)->max_baudrate;
+      if (rating < max_rate) {
+        max_rate = rating;
+      }
+      targets[n++] = sensor;
+    }
+  }
+
+  if (n == 0) {
+    set_bus_rate(i2c_inst, pio_bus, TCN75A_BAUDRATE);
+    return TCN75A_BAUDRATE;
+  }
+
+  uint best = autotune_rates[0];
+  bool is_failed = false;
+  for (size_t r = 0; r < count_of(autotune_rates); r++) {
+    if (autotune_rates[r] > max_rate) {
+      break;
+    }
+    set_bus_rate(i2c_inst, pio_bus, autotune_rates[r]);
+    bool is_reliable = true;
+    for (size_t i = 0; i < n && is_reliable; i++) {
+      is_reliable = verify_sensor(targets[i], expected[i]);
+    }
+    if (!is_reliable) {
+      is_failed = true;
+      break;
+    }
+    best = autotune_rates[r];
+  }
+
+  uint chosen = best;
+  if (is_failed) {
+    chosen = best / 100 * (100 - I2C_AUTOTUNE_MARGIN_PCT);
+    if (chosen < autotune_rates[0]) {
+      chosen = autotune_rates[0];
+    }
+  }
+  set_bus_rate(i2c_inst, pio_bus, chosen);
+  return chosen;
+}
+
+/**
+ * @brief Auto-tunes the clock of every hardware and PIO I2C bus and prints
+ * the clocks chosen.
+ *
+ * @return None.
+ */
+void autotune_i2c_buses() {
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    printf("I2C%d: %u Hz\n", bus,
+           autotune_bus(proj_i2c[bus].i2c_inst, NULL));
+  }
+  printf("PIO I2C: %u Hz\n", autotune_bus(NULL, &proj_pio_i2c));
+}
@@ -0,0 +1,10 @@
+#ifndef __I2C_AUTOTUNE_H__
+#define __I2C_AUTOTUNE_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+uint autotune_bus(i2c_inst_t *i2c_inst, PioI2C *pio_bus);
+void autotune_i2c_buses();
+
+#endif
@@ -3,39 +3,233 @@
 #include <stdint.h>
 
 #include "config.h"
+#include "mem_plan.h"
+#include "sensor_driver.h"
 #include "util.h"
 
 /**
  * @brief Sets the I2C configuration for the specified pins.
  *
- * This function sets the I2C configuration for the specified pins by setting
- * the GPIO function to I2C and optionally pulling up the pins if the I2C
+ * This function initializes each I2C instance at its bus baud rate, sets the
+ * GPIO function of its pins to I2C and optionally pulls up the pins if the I2C
  * configuration has pull-up resistors.
  *
- * @param i2c A pointer to the I2CConfig struct containing the SDA and SCL pin
- * numbers, and the pull-up configuration.
+ * @param i2c A pointer to the I2CConfig array containing the I2C instance, the
+ * SDA and SCL pin numbers, and the pull-up configuration.
  * @param len The number of I2C configurations in the i2c array.
  *
  * @return None.
  */
 void set_i2c(const I2CConfig *i2c, size_t len) {
   for (size_t i = 0; i < len; i++) {
-    gpio_set_function(i2c->sda_pin_number, GPIO_FUNC_I2C);
-    gpio_set_function(i2c->scl_pin_number, GPIO_FUNC_I2C);
-    if (i2c->has_pullup) {
-      gpio_pull_up(i2c->sda_pin_number);
-      gpio_pull_up(i2c->scl_pin_number);
+    i2c_init(i2c[i].i2c_inst, i2c_get_bus_baudrate(i2c[i].i2c_inst));
+    gpio_set_function(i2c[i].sda_pin_number, GPIO_FUNC_I2C);
+    gpio_set_function(i2c[i].scl_pin_number, GPIO_FUNC_I2C);
+    if (i2c[i].has_pullup) {
+      gpio_pull_up(i2c[i].sda_pin_number);
+      gpio_pull_up(i2c[i].scl_pin_number);
     }
   }
 }
 
+// Bus timeout and recovery counters, shared by both cores.
+static volatile I2CRecoveryStats recovery_stats = {0};
+// Baud rate of each bus, indexed like proj_i2c. 0 selects TCN75A_BAUDRATE.
+static uint bus_baudrates[NUMBER_OF_I2C] = {0};
+
+/**
+ * @brief Looks up the pin configuration of an I2C instance.
+ *
+ * @param i2c_inst A pointer to the I2C instance to look up.
+ *
+ * @return A pointer to the matching entry of proj_i2c, or NULL if the instance
+ * is not configured.
+ */
+static const I2CConfig *find_i2c_config(i2c_inst_t *i2c_inst) {
+  for (size_t i = 0; i < NUMBER_OF_I2C; i++) {
+    if (proj_i2c[i].i2c_inst == i2c_inst) {
+      return &proj_i2c[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Returns the baud rate an I2C instance is configured to run at.
+ *
+ * @param i2c_inst A pointer to the I2C instance.
+ *
+ * @return The bus baud rate in Hz.
+ */
+uint i2c_get_bus_baudrate(i2c_inst_t *i2c_inst) {
+  const I2CConfig *cfg = find_i2c_config(i2c_inst);
+  if (cfg == NULL || bus_baudrates[cfg - proj_i2c] == 0) {
+    return TCN75A_BAUDRATE;
+  }
+  return bus_baudrates[cfg - proj_i2c];
+}
+
+/**
+ * @brief Changes the baud rate of an I2C instance.
+ *
+ * The new rate is applied immediately and kept for later re-initializations,
+ * such as those done by i2c_bus_recover.
+ *
+ * @param i2c_inst A pointer to the I2C instance.
+ * @param baudrate The new bus baud rate in Hz.
+ *
+ * @return The baud rate actually achieved by the controller.
+ */
+uint i2c_set_bus_baudrate(i2c_inst_t *i2c_inst, uint baudrate) {
+  const I2CConfig *cfg = find_i2c_config(i2c_inst);
+  if (cfg == NULL) {
+    return 0;
+  }
+  bus_baudrates[cfg - proj_i2c] = baudrate;
+  return i2c_set_baudrate(i2c_inst, baudrate);
+}
+
+/**
+ * @brief Drives an open-drain line low or releases it.
+ *
+ * The line is pulled low by enabling the output with a 0 latched, and released
+ * by switching it back to an input so the pull-up can raise it.
+ *
+ * @param pin The GPIO pin number of the line.
+ * @param is_low true to drive the line low, false to release it.
+ *
+ * @return None.
+ */
+static void set_open_drain(uint pin, bool is_low) {
+  gpio_set_dir(pin, is_low ? GPIO_OUT : GPIO_IN);
+  busy_wait_us_32(I2C_RECOVERY_HALF_PERIOD_MICRO_SEC);
+}
+
+/**
+ * @brief Releases a bus held low by a slave stuck mid-transfer.
+ *
+ * This function takes the SDA and SCL pins over as GPIOs, clocks out up to
+ * I2C_RECOVERY_CLOCK_PULSES pulses on SCL until the slave holding SDA low
+ * releases it, and issues a STOP condition. The caller is responsible for
+ * handing the pins back to their peripheral afterwards.
+ *
+ * @param sda The GPIO pin number of SDA.
+ * @param scl The GPIO pin number of SCL.
+ *
+ * @return true if SDA is released, false otherwise.
+ */
+bool i2c_bus_clear(uint sda, uint scl) {
+  gpio_set_function(sda, GPIO_FUNC_SIO);
+  gpio_set_function(scl, GPIO_FUNC_SIO);
+  gpio_put(sda, 0);
+  gpio_put(scl, 0);
+  set_open_drain(sda, false);
+  set_open_drain(scl, false);
+
+  for (int i = 0; i < I2C_RECOVERY_CLOCK_PULSES && !gpio_get(sda); i++) {
+    set_open_drain(scl, true);
+    set_open_drain(scl, false);
+  }
+
+  // STOP condition: SDA rises while SCL is high
+  set_open_drain(scl, true);
+  set_open_drain(sda, true);
+  set_open_drain(scl, false);
+  set_open_drain(sda, false);
+  return gpio_get(sda);
+}
+
+/**
+ * @brief Recovers a hung I2C bus.
+ *
+ * This function disables the I2C peripheral, clears the bus with
+ * i2c_bus_clear, and then re-initializes the peripheral with set_i2c. The
+ * recovery time is recorded in the recovery statistics.
+ *
+ * @param i2c_inst A pointer to the I2C instance to recover.
+ *
+ * @return true if SDA is released after recovery, false otherwise.
+ */
+bool i2c_bus_recover(i2c_inst_t *i2c_inst) {
+  const I2CConfig *cfg = find_i2c_config(i2c_inst);
+  if (cfg == NULL) {
+    return false;
+  }
+
+  absolute_time_t start = get_absolute_time();
+
+  i2c_deinit(i2c_inst);
+  bool is_released = i2c_bus_clear(cfg->sda_pin_number, cfg->scl_pin_number);
+  set_i2c(cfg, 1);
+
+  uint32_t elapsed_us =
+      (uint32_t)absolute_time_diff_us(start, get_absolute_time());
+  recovery_stats.last_recovery_us = elapsed_us;
+  if (elapsed_us > recovery_stats.max_recovery_us) {
+    recovery_stats.max_recovery_us = elapsed_us;
+  }
+  if (is_released) {
+    recovery_stats.recoveries++;
+  } else {
+    recovery_stats.failed_recoveries++;
+  }
+
+  return is_released;
+}
+
+/**
+ * @brief Records a failed transfer in the recovery statistics.
+ *
+ * @param ret The value returned by the SDK transfer function.
+ *
+ * @return None.
+ */
+static void HOT_PATH_FUNC(record_xfer_error)(int ret) {
+  if (ret == PICO_ERROR_TIMEOUT) {
+    recovery_stats.timeouts++;
+  } else {
+    recovery_stats.errors++;
+  }
+}
+
+/**
+ * @brief Prints the bus timeout and recovery statistics to the console.
+ *
+ * @return None.
+ */
+void print_i2c_recovery_stats() {
+  printf("I2C timeouts: %lu, errors: %lu\n",
+         (unsigned long)recovery_stats.timeouts,
+         (unsigned long)recovery_stats.errors);
+  printf("I2C recoveries: %lu ok, %lu failed, last %lu us, max %lu us\n",
+         (unsigned long)recovery_stats.recoveries,
+         (unsigned long)recovery_stats.failed_recoveries,
+         (unsigned long)recovery_stats.last_recovery_us,
+         (unsigned long)recovery_stats.max_recovery_us);
+  printf("I2C worst-case stall per transaction: %d us\n",
+         I2C_WORST_CASE_STALL_MICRO_SEC);
+}
+
+/**
+ * @brief Returns the number of hardware bus recoveries since boot.
+ *
+ * @return The number of successful and failed recoveries.
+ */
+uint32_t i2c_recovery_count() {
+  return recovery_stats.recoveries + recovery_stats.failed_recoveries;
+}
+
 /**
  * @brief Writes data to a register over I2C.
  *
  * This function writes data to a register over I2C. The register address is
  * appended to the front of the data packet, and the resulting message is sent
- * to the specified I2C address. The function returns the number of bytes
- * written.
+ * to the specified I2C address. Each attempt is bounded by
+ * I2C_XFER_TIMEOUT_MICRO_SEC; a timed out attempt triggers a bus recovery
+ * and the write is retried up to I2C_MAX_RETRIES times. A NAK is returned
+ * as-is, since retrying an absent device cannot succeed. The message is
+ * built in the calling core's slot of i2c_msg_pool, so at most
+ * I2C_MAX_REG_BYTES can be written.
  *
  * @param i2c_inst A pointer to the I2C instance to use for the write.
  * @param addr The I2C address to write to.
@@ -43,20 +237,37 @@ void set_i2c(const I2CConfig *i2c, size_t len) {
  * @param buf A pointer to the buffer containing the data to write.
  * @param nbytes The number of bytes to write to the register.
  *
- * @return The number of bytes written to the register.
+ * @return The number of bytes written to the register, or a PICO_ERROR code.
  */
-int reg_write(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
-              uint8_t *buf, const uint8_t nbytes) {
+int HOT_PATH_FUNC(reg_write)(i2c_inst_t *i2c_inst, const uint8_t addr,
+                             const uint8_t reg, uint8_t *buf,
+                             const uint8_t nbytes) {
   int num_bytes_read = 0;
-  uint8_t msg[nbytes + 1];
+  uint8_t *msg = i2c_msg_pool[get_core_num()];
 
+  if (nbytes > I2C_MAX_REG_BYTES) {
+    return PICO_ERROR_INVALID_ARG;
+  }
   msg[0] = reg;
   for (int i = 0; i < nbytes; i++) {
     msg[i + 1] = buf[i];
   }
 
-  num_bytes_read = i2c_write_blocking(i2c_inst, addr, msg, (nbytes + 1), false);
-  
+  for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+    if (attempt > 0) {
+      i2c_bus_recover(i2c_inst);
+    }
+    num_bytes_read = i2c_write_timeout_us(i2c_inst, addr, msg, (nbytes + 1),
+                                          false, I2C_XFER_TIMEOUT_MICRO_SEC);
+    if (num_bytes_read >= 0) {
+      break;
+    }
+    record_xfer_error(num_bytes_read);
+    if (num_bytes_read != PICO_ERROR_TIMEOUT) {
+      break;
+    }
+  }
+
   return num_bytes_read;
 }
 
@@ -65,7 +276,10 @@ int reg_write(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
  *
  * This function reads data from a register over I2C. The register address is
  * sent to the specified I2C address, and the resulting data is read into the
- * provided buffer. The function returns the number of bytes read.
+ * provided buffer. Both phases are bounded by I2C_XFER_TIMEOUT_MICRO_SEC; a
+ * timed out attempt triggers a bus recovery and the read is retried up to
+ * I2C_MAX_RETRIES times, so the total stall never exceeds
+ * I2C_WORST_CASE_STALL_MICRO_SEC.
  *
  * @param i2c_inst A pointer to the I2C instance to use for the read.
  * @param addr The I2C address to read from.
@@ -73,22 +287,150 @@ int reg_write(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
  * @param buf A pointer to the buffer to store the read data.
  * @param nbytes The number of bytes to read from the register.
  *
- * @return The number of bytes read from the register.
+ * @return The number of bytes read from the register, or a PICO_ERROR code.
  */
-int reg_read(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
-             uint8_t *buf, const uint8_t nbytes) {
+int HOT_PATH_FUNC(reg_read)(i2c_inst_t *i2c_inst, const uint8_t addr,
+                            const uint8_t reg, uint8_t *buf,
+                            const uint8_t nbytes) {
   int num_bytes_read = 0;
 
   if (nbytes < 1) {
     return 0;
   }
 
-  i2c_write_blocking(i2c_inst, addr, &reg, 1, true);
-  num_bytes_read = i2c_read_blocking(i2c_inst, addr, buf, nbytes, false);
+  for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+    if (attempt > 0) {
+      i2c_bus_recover(i2c_inst);
+    }
+    num_bytes_read = i2c_write_timeout_us(i2c_inst, addr, &reg, 1, true,
+                                          I2C_XFER_TIMEOUT_MICRO_SEC);
+    if (num_bytes_read >= 0) {
+      num_bytes_read = i2c_read_timeout_us(i2c_inst, addr, buf, nbytes, false,
+                                           I2C_XFER_TIMEOUT_MICRO_SEC);
+    }
+    if (num_bytes_read >= 0) {
+      break;
+    }
+    record_xfer_error(num_bytes_read);
+    if (num_bytes_read != PICO_ERROR_TIMEOUT) {
+      break;
+    }
+  }
 
   return num_bytes_read;
 }
 
+/**
+ * @brief Starts a register read without waiting for it to complete.
+ *
+ * This function queues the register address write and the read commands
+ * directly in the controller's TX FIFO and returns immediately, so transfers
+ * on several I2C instances can be in flight at the same time. The result is
+ * collected with reg_read_poll. The address write and one command per byte
+ * must all fit in the TX FIFO, so at most I2C_FIFO_DEPTH - 1 bytes can be
+ * read. Bytes left in the RX FIFO by an earlier transfer are discarded first,
+ * so reg_read_poll only sees this read.
+ *
+ * @param i2c_inst A pointer to the I2C instance to use for the read.
+ * @param addr The I2C address to read from.
+ * @param reg The register address to read from.
+ * @param nbytes The number of bytes to read from the register.
+ *
+ * @return 0 once the read is queued, or PICO_ERROR_INVALID_ARG if nbytes is 0
+ * or does not fit in the FIFO.
+ */
+int HOT_PATH_FUNC(reg_read_start)(i2c_inst_t *i2c_inst, const uint8_t addr,
+                                  const uint8_t reg, const uint8_t nbytes) {
+  i2c_hw_t *hw = i2c_get_hw(i2c_inst);
+
+  if (nbytes == 0 || nbytes > I2C_FIFO_DEPTH - 1) {
+    return PICO_ERROR_INVALID_ARG;
+  }
+  while (hw->rxflr > 0) {
+    (void)hw->data_cmd;
+  }
+
+  hw->enable = 0;
+  hw->tar = addr;
+  hw->enable = 1;
+
+  hw->data_cmd = reg;
+  for (int i = 0; i < nbytes; i++) {
+    hw->data_cmd = I2C_IC_DATA_CMD_CMD_BITS |
+                   (i == 0 ? I2C_IC_DATA_CMD_RESTART_BITS : 0) |
+                   (i == nbytes - 1 ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+  }
+  return 0;
+}
+
+/**
+ * @brief Collects the result of a read started with reg_read_start.
+ *
+ * @param i2c_inst A pointer to the I2C instance the read was started on.
+ * @param buf A pointer to the buffer to store the read data.
+ * @param nbytes The number of bytes that were requested.
+ *
+ * @return The number of bytes read once the transfer is complete, 0 while it
+ * is still in flight, or PICO_ERROR_GENERIC if the transfer was aborted.
+ */
+int HOT_PATH_FUNC(reg_read_poll)(i2c_inst_t *i2c_inst, uint8_t *buf,
+                                 const uint8_t nbytes) {
+  i2c_hw_t *hw = i2c_get_hw(i2c_inst);
+
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    (void)hw->clr_tx_abrt;
+    return PICO_ERROR_GENERIC;
+  }
+  if (hw->rxflr < nbytes) {
+    return 0;
+  }
+  for (int i = 0; i < nbytes; i++) {
+    buf[i] = (uint8_t)hw->data_cmd;
+  }
+  return nbytes;
+}
+
+/**
+ * @brief Reads data from a register of a sensor on either kind of bus.
+ *
+ * This function dispatches to reg_read for sensors on a hardware I2C
+ * instance and to pio_i2c_reg_read for sensors on a PIO I2C bus.
+ *
+ * @param sensor A pointer to the sensor to read from.
+ * @param reg The register address to read from.
+ * @param buf A pointer to the buffer to store the read data.
+ * @param nbytes The number of bytes to read from the register.
+ *
+ * @return The number of bytes read from the register, or a PICO_ERROR code.
+ */
+int HOT_PATH_FUNC(sensor_reg_read)(const SensorConfig *sensor,
+                                   const uint8_t reg, uint8_t *buf,
+                                   const uint8_t nbytes) {
+  if (sensor->i2c_inst != NULL) {
+    return reg_read(sensor->i2c_inst, sensor->addr, reg, buf, nbytes);
+  }
+  return pio_i2c_reg_read(sensor->pio_bus, sensor->addr, reg, buf, nbytes);
+}
+
+/**
+ * @brief Writes data to a register of a sensor on either kind of bus.
+ *
+ * @param sensor A pointer to the sensor to write to.
+ * @param reg The register address to write to.
+ * @param buf A pointer to the buffer containing the data to write.
+ * @param nbytes The number of bytes to write to the register.
+ *
+ * @return The number of bytes written to the register, or a PICO_ERROR code.
+ */
+int HOT_PATH_FUNC(sensor_reg_write)(const SensorConfig *sensor,
+                                    const uint8_t reg, uint8_t *buf,
+                                    const uint8_t nbytes) {
+  if (sensor->i2c_inst != NULL) {
+    return reg_write(sensor->i2c_inst, sensor->addr, reg, buf, nbytes);
+  }
+  return pio_i2c_reg_write(sensor->pio_bus, sensor->addr, reg, buf, nbytes);
+}
+
 /**
  * @brief Checks if an I2C device is present at the specified address.
  *
@@ -116,7 +458,9 @@ int check_addr(i2c_inst_t *i2c, uint8_t addr, uint8_t *rxdata, uint timeout) {
  * This function scans the I2C bus for devices by attempting to read one byte of
  * data from each possible address on the bus. For each address, the function
  * prints a character to the console indicating whether a device was detected at
- * that address or not. The function skips over any reserved addresses.
+ * that address or not. The function skips over any reserved addresses. Every
+ * device found is then probed by the sensor drivers, and the part it was
+ * identified as is listed below the grid.
  *
  * @param i2c A pointer to the I2C instance to use for the scan.
  * @param timeout The timeout (in microseconds) for the check_addr function.
@@ -124,6 +468,7 @@ int check_addr(i2c_inst_t *i2c, uint8_t addr, uint8_t *rxdata, uint timeout) {
  * @return None.
  */
 void scan_i2c_bus(i2c_inst_t *i2c, uint timeout) {
+  uint32_t found[(1 << 7) / 32] = {0};
   printf("\nI2C Bus Scan\n");
   printf("   0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
 
@@ -139,10 +484,21 @@ void scan_i2c_bus(i2c_inst_t *i2c, uint timeout) {
     } else {
       ret = check_addr(i2c, addr, &rxdata, timeout);
       printf(ret <= 0 ? "." : "@");
+      if (ret > 0) {
+        found[addr / 32] |= 1u << (addr % 32);
+      }
     }
 
     printf(addr % 16 == 15 ? "\n" : "  ");
   }
+
+  for (uint8_t addr = 0; addr < (1 << 7); ++addr) {
+    if (found[addr / 32] & (1u << (addr % 32))) {
+      SensorConfig sensor = {.i2c_inst = i2c, .addr = addr};
+      const SensorDriver *driver = sensor_driver_probe(&sensor);
+      printf("0x%02x: %s\n", addr, driver != NULL ? driver->name : "unknown");
+    }
+  }
   printf("Done.\n");
 }
 
@@ -167,233 +523,6 @@ bool reserved_addr(uint8_t addr) {
   }
 }
 
-/**
- * @brief Reads data from a register on a temperature sensor over I2C.
- *
- * This function reads data from a register on a temperature sensor over I2C.
- * The function calls the reg_read function with the specified I2C instance,
- * device address, register address, buffer, and number of bytes to read.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param reg_addr The register address to read from.
- * @param buf A pointer to the buffer to store the read data.
- * @param nbytes The number of bytes to read from the register.
- *
- * @return None.
- */
-void read_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr,
-                   uint8_t *buf, uint8_t nbytes) {
-  reg_read(i2c, dev_addr, reg_addr, buf, nbytes);
-}
-
-/**
- * @brief Writes data to a register on a temperature sensor over I2C.
- *
- * This function writes data to a register on a temperature sensor over I2C. The
- * function calls the reg_write function with the specified I2C instance, device
- * address, register address, buffer, and number of bytes to write.
- *
- * @param i2c A pointer to the I2C instance to use for the write.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param reg_addr The register address to write to.
- * @param buf A pointer to the buffer containing the data to write.
- * @param nbytes The number of bytes to write to the register.
- *
- * @return None.
- */
-void write_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr,
-                    uint8_t *buf, uint8_t nbytes) {
-  reg_write(i2c, dev_addr, reg_addr, buf, nbytes);
-}
-
-/**
- * @brief Reads temperature data from a pair of registers on a temperature
- * sensor over I2C.
- *
- * This function reads temperature data from a pair of registers on a
- * temperature sensor over I2C. The function calls the read_temp_reg function
- * with the specified I2C instance, device address, register address, buffer,
- * and number of bytes to read. The function then prints a message to the
- * console, and calls the print_temp_table function to display the temperature
- * data in a formatted table.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param reg_addr The register address to read from.
- * @param buf A pointer to the buffer to store the read data.
- * @param nbytes The number of bytes to read from the register.
- * @param message The message to display before the temperature table.
- *
- * @return None.
- */
-void read_temperature_registers(i2c_inst_t *i2c, uint8_t dev_addr,
-                                uint8_t reg_addr, uint8_t *buf, uint8_t nbytes,
-                                const char *message) {
-  read_temp_reg(i2c, dev_addr, reg_addr, buf, nbytes);
-  printf("%s\n", message);
-  print_temp_table(buf[0], buf[1]);
-}
-
-/**
- * @brief Reads and displays the ambient temperature from a temperature sensor
- * over I2C.
- *
- * This function reads the ambient temperature from a temperature sensor over
- * I2C by calling the read_temperature_registers function with the specified I2C
- * instance, device address, register address, buffer, number of bytes to read,
- * and message. The function then clears the console screen and displays the
- * temperature data in a formatted table.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- *
- * @return None.
- */
-void print_ambient_temperature(i2c_inst_t *i2c, uint8_t dev_addr) {
-  uint8_t nbytes = 2;
-  uint8_t tmp[2] = {0, 0};
-  clear_screen();
-  read_temperature_registers(i2c, dev_addr, AMBIENT_TEMP_REG, tmp, nbytes,
-                             "Ambient Temperature");
-}
-
-/**
- * @brief Reads and displays the temperature hysteresis limit from a temperature
- * sensor over I2C.
- *
- * This function reads the temperature hysteresis limit from a temperature
- * sensor over I2C by calling the read_temperature_registers function with the
- * specified I2C instance, device address, register address, buffer, number of
- * bytes to read, and message. The function then displays the temperature data
- * in a formatted table.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- *
- * @return None.
- */
-void read_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr) {
-  uint8_t nbytes = 2;
-  uint8_t tmp[2] = {0, 0};
-  read_temperature_registers(i2c, dev_addr, TEMP_HYST_MIN_REG, tmp, nbytes,
-                       "Temperature Hyst Limit");
-}
-
-/**
- * @brief Sets the temperature hysteresis limit on a temperature sensor over
- * I2C.
- *
- * This function sets the temperature hysteresis limit on a temperature sensor
- * over I2C by writing the specified integer and decimal parts to the
- * appropriate registers using the write_temp_reg function. The function then
- * reads and displays the updated temperature hysteresis limit using the
- * read_temp_hyst_limit function.
- *
- * @param i2c A pointer to the I2C instance to use for the write.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param integer_part The integer part of the temperature hysteresis limit.
- * @param decimal_part The decimal part of the temperature hysteresis limit.
- *
- * @return None.
- */
-void write_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr,
-                           uint8_t integer_part, uint8_t decimal_part) {
-  uint8_t nbytes = 2;
-  uint8_t tmp[2] = {[0]=integer_part, [1]=decimal_part};
-  write_temp_reg(i2c, dev_addr, TEMP_HYST_MIN_REG, tmp, nbytes);
-  read_temp_hyst_limit(i2c, dev_addr);
-}
-
-/**
- * @brief Reads and displays the temperature set limit from a temperature sensor
- * over I2C.
- *
- * This function reads the temperature set limit from a temperature sensor over
- * I2C by calling the read_temperature_registers function with the specified I2C
- * instance, device address, register address, buffer, number of bytes to read,
- * and message. The function then displays the temperature data in a formatted
- * table.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- *
- * @return None.
- */
-void read_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr) {
-  uint8_t nbytes = 2;
-  uint8_t tmp[2] = {0, 0};
-  read_temperature_registers(i2c, dev_addr, TEMP_SET_MAX_REG, tmp, nbytes,
-                             "Temperature Set Limit");
-}
-
-/**
- * @brief Sets the temperature set limit on a temperature sensor over I2C.
- *
- * This function sets the temperature set limit on a temperature sensor over I2C
- * by writing the specified integer and decimal parts to the appropriate
- * registers using the write_temp_reg function. The function then reads and
- * displays the updated temperature set limit using the read_temp_set_limit
- * function.
- *
- * @param i2c A pointer to the I2C instance to use for the write.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param integer_part The integer part of the temperature set limit.
- * @param decimal_part The decimal part of the temperature set limit.
- *
- * @return None.
- */
-void write_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr,
-                          uint8_t integer_part, uint8_t decimal_part) {
-  uint8_t nbytes = 2;
-  uint8_t tmp[2] = {[0]=integer_part, [1]=decimal_part};
-  write_temp_reg(i2c, dev_addr, TEMP_SET_MAX_REG, tmp, nbytes);
-  read_temp_set_limit(i2c, dev_addr);
-}
-
-/**
- * @brief Reads and returns the configuration register value from a temperature
- * sensor over I2C.
- *
- * This function reads the configuration register value from a temperature
- * sensor over I2C by calling the read_temp_reg function with the specified I2C
- * instance, device address, register address, buffer, and number of bytes to
- * read.
- *
- * @param i2c A pointer to the I2C instance to use for the read.
- * @param dev_addr The I2C address of the temperature sensor.
- *
- * @return The value of the configuration register.
- */
-uint8_t read_config(i2c_inst_t *i2c, uint8_t dev_addr) {
-  uint8_t nbytes = 1;
-  uint8_t tmp[1] = {0};
-  read_temp_reg(i2c, dev_addr, SENSOR_CONFIG_REG, tmp, nbytes);
-  return tmp[0];
-}
-
-/**
- * @brief Writes the configuration register value to a temperature sensor over
- * I2C.
- *
- * This function writes the specified configuration register value to a
- * temperature sensor over I2C by calling the write_temp_reg function with the
- * specified I2C instance, device address, register address, buffer, and number
- * of bytes to write.
- *
- * @param i2c A pointer to the I2C instance to use for the write.
- * @param dev_addr The I2C address of the temperature sensor.
- * @param conf The value to write to the configuration register.
- *
- * @return Always returns 0.
- */
-uint8_t write_config(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t conf) {
-  uint8_t nbytes = 1;
-  uint8_t tmp[1] = {conf};
-  write_temp_reg(i2c, dev_addr, SENSOR_CONFIG_REG, tmp, nbytes);
-  return 0;
-}
-
 /**
  * @brief Prints a temperature data table to the console.
  *
@@ -3,36 +3,72 @@
 
 #include "hardware/i2c.h"
 #include "pico/stdlib.h"
+#include "pio_i2c.h"
 #include <stdio.h>
 
 typedef struct {
+  i2c_inst_t *i2c_inst;
   uint sda_pin_number;
   uint scl_pin_number;
   bool has_pullup;
 } I2CConfig;
 
+// Operations of a temperature sensor part, see sensor_driver.h
+typedef struct SensorDriver SensorDriver;
+
+// Struct for storing the location of a polled temperature sensor
+// i2c_inst the I2C instance the sensor is attached to, or NULL
+// pio_bus the PIO I2C bus the sensor is attached to, when i2c_inst is NULL
+// addr the I2C address of the sensor
+// driver the part at that address, or NULL for a TCN75A
+typedef struct {
+  i2c_inst_t *i2c_inst;
+  PioI2C *pio_bus;
+  uint8_t addr;
+  const SensorDriver *driver;
+} SensorConfig;
+
+// Counters describing bus timeouts and recoveries since boot
+// timeouts the number of transfers that exceeded their deadline
+// errors the number of transfers that were NAKed or aborted
+// recoveries the number of successful bus recoveries
+// failed_recoveries the number of recoveries that left SDA stuck low
+// last_recovery_us the duration of the most recent recovery
+// max_recovery_us the longest recovery observed
+typedef struct {
+  uint32_t timeouts;
+  uint32_t errors;
+  uint32_t recoveries;
+  uint32_t failed_recoveries;
+  uint32_t last_recovery_us;
+  uint32_t max_recovery_us;
+} I2CRecoveryStats;
+
 void set_i2c(const I2CConfig *i2c, size_t len);
+uint i2c_get_bus_baudrate(i2c_inst_t *i2c_inst);
+uint i2c_set_bus_baudrate(i2c_inst_t *i2c_inst, uint baudrate);
+bool i2c_bus_clear(uint sda, uint scl);
+bool i2c_bus_recover(i2c_inst_t *i2c_inst);
+void print_i2c_recovery_stats();
+uint32_t i2c_recovery_count();
 
 int reg_write(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
               uint8_t *buf, const uint8_t nbytes);
 
 int reg_read(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
              uint8_t *buf, const uint8_t nbytes);
+int sensor_reg_read(const SensorConfig *sensor, const uint8_t reg,
+                    uint8_t *buf, const uint8_t nbytes);
+int sensor_reg_write(const SensorConfig *sensor, const uint8_t reg,
+                     uint8_t *buf, const uint8_t nbytes);
+int reg_read_start(i2c_inst_t *i2c_inst, const uint8_t addr, const uint8_t reg,
+                   const uint8_t nbytes);
+int reg_read_poll(i2c_inst_t *i2c_inst, uint8_t *buf, const uint8_t nbytes);
 
 void scan_i2c_bus(i2c_inst_t *i2c, uint timeout);
 bool reserved_addr(uint8_t addr);
 int check_addr(i2c_inst_t *i2c, uint8_t addr, uint8_t *rxdata, uint timeout);
 
-void read_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes);
-void write_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes);
-void read_temperature_registers(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes, const char *message);
-void print_ambient_temperature(i2c_inst_t *i2c, uint8_t dev_addr);
-void read_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr);
-void write_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t integer_part, uint8_t decimal_part);
-void read_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr);
-void write_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t integer_part, uint8_t decimal_part);
-uint8_t read_config(i2c_inst_t *i2c, uint8_t dev_addr);
-uint8_t write_config(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t conf);
 void print_temp_table(uint8_t integer_part, uint8_t decimal_part);
 
 #endif
@@ -0,0 +1,143 @@
+#include "config.h"
+#include "sensor_driver.h"
+#include "tcn75a.h"
+
+// LM75 registers, the map the TCN75A extends.
+#define LM75_TEMP_REG 0x00
+#define LM75_CONFIG_REG 0x01
+
+// Config register bits the LM75 leaves unimplemented.
+#define LM75_RESERVED_MASK 0b11100000
+// Bits implemented by the temperature register (0.125 C resolution).
+#define LM75_TEMP_MASK 0xFFE0
+#define LM75_BITS 11
+// Typical conversion time (10 conversions per second).
+#define LM75_CONVERSION_MS 100
+
+/**
+ * @brief Checks whether the device at a sensor's address is an LM75.
+ *
+ * The LM75 has no ID register, so any device that answers on both the
+ * temperature and config registers with the reserved config bits clear is
+ * taken to be one. It is probed last, after the TCN75A.
+ *
+ * @param sensor A pointer to the sensor to probe.
+ *
+ * @return true if the device looks like an LM75, false otherwise.
+ */
+static bool lm75_probe(const SensorConfig *sensor) {
+  uint8_t conf;
+  uint16_t temp;
+  return sensor_reg_read(sensor, LM75_CONFIG_REG, &conf, 1) == 1 &&
+         (conf & LM75_RESERVED_MASK) == 0 &&
+         sensor_driver_read_word(sensor, LM75_TEMP_REG, &temp) == 2;
+}
+
+/**
+ * @brief Returns the resolution of an LM75, which is fixed.
+ *
+ * @param sensor Ignored.
+ *
+ * @return LM75_BITS.
+ */
+static uint8_t lm75_resolution(const SensorConfig *sensor) { return LM75_BITS; }
+
+/**
+ * @brief Returns the typical conversion time of an LM75.
+ *
+ * @param bits Ignored.
+ *
+ * @return LM75_CONVERSION_MS.
+ */
+static uint32_t lm75_conversion_ms(uint8_t bits) { return LM75_CONVERSION_MS; }
+
+/**
+ * @brief Writes the config register of an LM75.
+ *
+ * The LM75 shares the low five bits of the TCN75A config register. It has no
+ * ADC resolution or one-shot field, so those bits are written as 0.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param conf The config value in the TCN75A_CONFIG_FIELDS layout.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if the write failed.
+ */
+static int lm75_configure(const SensorConfig *sensor, uint8_t conf) {
+  uint8_t buf[1] = {conf & ~LM75_RESERVED_MASK};
+  int ret = sensor_reg_write(sensor, LM75_CONFIG_REG, buf, 1);
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the config register of an LM75, with the ADC resolution field
+ * set to its fixed resolution.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param conf A pointer that receives the config value in the
+ * TCN75A_CONFIG_FIELDS layout.
+ *
+ * @return true if the register was read, false otherwise.
+ */
+static bool lm75_read_config(const SensorConfig *sensor, uint8_t *conf) {
+  uint8_t reg;
+  if (sensor_reg_read(sensor, LM75_CONFIG_REG, &reg, 1) != 1) {
+    return false;
+  }
+  *conf = (reg & ~LM75_RESERVED_MASK) |
+          config_field_encode(ADC_RESOLUTION_FIELD, LM75_BITS - 9);
+  return true;
+}
+
+/**
+ * @brief Reads the temperature register of an LM75.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param raw A pointer that receives the register value.
+ *
+ * @return The number of bytes read, or a PICO_ERROR code.
+ */
+static int lm75_read_raw(const SensorConfig *sensor, uint16_t *raw) {
+  return sensor_driver_read_word(sensor, LM75_TEMP_REG, raw);
+}
+
+/**
+ * @brief Converts an LM75 temperature register value to 1/256 C.
+ *
+ * @param raw The register value, left aligned with 0.125 C resolution.
+ *
+ * @return The temperature in 1/256 C.
+ */
+static int16_t HOT_PATH_FUNC(lm75_convert)(uint16_t raw) {
+  return (int16_t)(raw & LM75_TEMP_MASK);
+}
+
+/**
+ * @brief Writes the THYST and TOS registers of an LM75, which keep 0.5 C
+ * steps.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param hyst The temperature below which OS releases, in 1/256 C.
+ * @param set The temperature above which OS asserts, in 1/256 C.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a write failed.
+ */
+static int lm75_alert_config(const SensorConfig *sensor, int16_t hyst,
+                             int16_t set) {
+  return sensor_driver_write_limits(sensor, hyst, set, TEMP_LIMIT_REG_MASK);
+}
+
+const SensorDriver lm75_driver = {.name = "LM75",
+                                  .first_addr = 0x48,
+                                  .last_addr = 0x4F,
+                                  .max_baudrate = 400 * 1000,
+                                  .temp_reg = LM75_TEMP_REG,
+                                  .config_mask = (uint8_t)~LM75_RESERVED_MASK,
+                                  .probe = lm75_probe,
+                                  .resolution = lm75_resolution,
+                                  .conversion_ms = lm75_conversion_ms,
+                                  .configure = lm75_configure,
+                                  .read_config = lm75_read_config,
+                                  .read_raw = lm75_read_raw,
+                                  .convert = lm75_convert,
+                                  .alert_config = lm75_alert_config,
+                                  .read_alert = sensor_driver_read_limits};
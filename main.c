@@ -1,8 +1,29 @@
 // Include necessary header files.
 #include <stdio.h>
 
+#include "adaptive_rate.h"
+#include "alert_engine.h"
+#include "alert_irq.h"
+#include "benchmark.h"
 #include "config.h"
+#include "console.h"
 #include "debounce.h"
+#include "edge_capture.h"
+#include "event_loop.h"
+#include "event_queue.h"
+#include "fast_boot.h"
+#include "filter.h"
+#include "flash_util.h"
+#include "history.h"
+#include "mem_plan.h"
+#include "reg_cache.h"
+#include "sample_log.h"
+#include "oversample.h"
+#include "profile.h"
+#include "sensor_driver.h"
+#include "sensor_poll.h"
+#include "tcn75a.h"
+#include "trend.h"
 #include "pico/multicore.h"
 
 
@@ -22,6 +43,11 @@ extern void gpio_callback();
 bool enable_read_temp = false;
 i2c_inst_t *i2c = i2c0;
 uint8_t dev_addr = TCN75A_DEFAULT_ADDR;
+// Sampling period and the bit mask of sampled sensors, set by profiles.
+uint32_t sample_interval_ms = SAMPLE_INTERVAL_MS;
+uint32_t active_sensors = ALL_SENSORS_MASK;
+// Latest reading of every sensor in proj_sensors.
+SensorSample samples[NUMBER_OF_SENSORS];
 // Define a struct to represent the state of each button.
 volatile BtnState btns[NUMBER_OF_BTNS] = {{BTN0, false, false, 0, 0},
                                           {BTN1, false, false, 0, 0},
@@ -29,51 +55,319 @@ volatile BtnState btns[NUMBER_OF_BTNS] = {{BTN0, false, false, 0, 0},
                                           {BTN3, false, false, 0, 0},
                                           {BTN4, false, false, 0, 0}};
 
+/**
+ * @brief Toggles the onboard LED twice per sampling period.
+ *
+ * @param now The time the task was started.
+ *
+ * @return The time of the next toggle.
+ */
+static absolute_time_t heartbeat_task(absolute_time_t now) {
+  gpio_put(ONBOARD_LED, !gpio_get(ONBOARD_LED));
+  return delayed_by_ms(now, sample_interval_ms / 2);
+}
+
+// Whether the sampling task ran with temperature reading enabled last time.
+static bool was_sampling = false;
+
+/**
+ * @brief Returns whether temperature reading was just enabled, so the first
+ * sample does not wait for the rest of the period.
+ *
+ * @return true if the sampling task should run now.
+ */
+static bool sample_ready() { return enable_read_temp && !was_sampling; }
+
+/**
+ * @brief Returns which sensors hold a new reading after poll_sensors.
+ *
+ * @param polled_mask The bit mask of sensors that were read.
+ *
+ * @return The bit mask of polled sensors whose read succeeded.
+ */
+static uint32_t valid_sample_mask(uint32_t polled_mask) {
+  uint32_t valid_mask = 0;
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if ((polled_mask & (1u << i)) && samples[i].status == 2) {
+      valid_mask |= 1u << i;
+    }
+  }
+  return valid_mask;
+}
+
+// Time the current temperatures were last printed.
+static absolute_time_t printed_at;
+
+/**
+ * @brief Filters, logs and stores the new samples in the history, then
+ * checks the alert thresholds and trends.
+ *
+ * @param valid_mask The bit mask of samples that hold a new reading.
+ *
+ * @return None.
+ */
+static void process_samples(uint32_t valid_mask) {
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if (valid_mask & (1u << i)) {
+      uint32_t timestamp_ms = to_ms_since_boot(samples[i].timestamp);
+      samples[i].filtered = filter_sample(i, (int16_t)samples[i].raw);
+      sample_log_append(i, timestamp_ms, samples[i].raw);
+      history_append(i, timestamp_ms, samples[i].raw);
+    }
+  }
+  alert_evaluate(samples, NUMBER_OF_SENSORS, valid_mask);
+  trend_evaluate(samples, NUMBER_OF_SENSORS, valid_mask);
+}
+
+/**
+ * @brief Polls the sensors that are due, then filters and logs the samples,
+ * checks the alert thresholds and trends and prints the current
+ * temperatures.
+ *
+ * With adaptive sampling each sensor is read at its own rate and the
+ * temperatures are still printed once per sampling period; otherwise every
+ * sensor is read once per period. Until a host connects after boot the
+ * samples are held in the boot buffer instead of being printed, whether or
+ * not temperature reading is enabled. This is deliberate: BTN4 only
+ * controls reading once a host is there to see it.
+ *
+ * @param now The time the task was started.
+ *
+ * @return The time of the next sample.
+ */
+static absolute_time_t sample_task(absolute_time_t now) {
+  was_sampling = enable_read_temp;
+  bool is_capturing = fast_boot_is_capturing();
+  if (!enable_read_temp && !is_capturing) {
+    return delayed_by_ms(now, sample_interval_ms);
+  }
+  bool is_adaptive = adaptive_is_enabled();
+  uint32_t polled_mask =
+      is_adaptive ? adaptive_due_mask(now, active_sensors) : active_sensors;
+  poll_sensors(proj_sensors, NUMBER_OF_SENSORS, polled_mask, samples);
+  uint32_t valid_mask = valid_sample_mask(polled_mask);
+  process_samples(valid_mask);
+  if (is_capturing) {
+    fast_boot_record(samples, NUMBER_OF_SENSORS, valid_mask);
+  } else if (!is_adaptive || absolute_time_diff_us(printed_at, now) >=
+                                 (int64_t)sample_interval_ms * 1000) {
+    print_sensor_samples(proj_sensors, samples, NUMBER_OF_SENSORS);
+    printed_at = now;
+  }
+  if (!is_adaptive) {
+    return delayed_by_ms(now, sample_interval_ms);
+  }
+  adaptive_update(proj_sensors, samples, NUMBER_OF_SENSORS, polled_mask,
+                  valid_mask, now);
+  return adaptive_next_deadline(active_sensors);
+}
+
+// Whether the latest samples have been printed to the host.
+static bool is_greeted = false;
+
+/**
+ * @brief Waits for a host to open the USB serial port, then prints the
+ * latest samples, the samples held since boot and the boot times.
+ *
+ * The latest samples are printed from memory rather than read from the bus,
+ * since core1 may own the buses for a scan or a menu when the host connects.
+ *
+ * @param now The time the task was started.
+ *
+ * @return The time of the next check, or at_the_end_of_time once the boot
+ * buffer has been flushed.
+ */
+static absolute_time_t usb_task(absolute_time_t now) {
+  if (!fast_boot_usb_ready()) {
+    return delayed_by_ms(now, FAST_BOOT_USB_POLL_MS);
+  }
+  if (!is_greeted) {
+    print_sensor_samples(proj_sensors, samples, NUMBER_OF_SENSORS);
+    is_greeted = true;
+  }
+  if (!fast_boot_flush()) {
+    return delayed_by_ms(now, CONSOLE_DRAIN_MS);
+  }
+  return at_the_end_of_time;
+}
+
+/**
+ * @brief Reads the oversampled sensors whose conversions are due.
+ *
+ * @param now The time the task was started.
+ *
+ * @return The next conversion deadline, or one sampling period from now so
+ * that a sensor switched to oversampling from a menu is picked up.
+ */
+static absolute_time_t oversample_task(absolute_time_t now) {
+  if (enable_read_temp) {
+    oversample_service(proj_sensors, NUMBER_OF_SENSORS);
+  }
+  absolute_time_t next = delayed_by_ms(now, sample_interval_ms);
+  absolute_time_t deadline = oversample_next_deadline();
+  return absolute_time_diff_us(deadline, next) > 0 ? deadline : next;
+}
+
+/**
+ * @brief Returns whether an ALERT edge is waiting and core0 owns the buses.
+ *
+ * @return true if the ALERT task should run now.
+ */
+static bool alert_ready() { return enable_read_temp && alert_irq_pending(); }
+
+/**
+ * @brief Performs the deferred read of a pending ALERT edge.
+ *
+ * @param now The time the task was started.
+ *
+ * @return at_the_end_of_time, since the task only runs on ALERT edges.
+ */
+static absolute_time_t alert_task(absolute_time_t now) {
+  alert_irq_service(proj_sensors, NUMBER_OF_SENSORS, active_sensors);
+  return at_the_end_of_time;
+}
+
+/**
+ * @brief Prints the queued alert and trend events.
+ *
+ * @param now The time the task was started.
+ *
+ * @return at_the_end_of_time, since the task only runs when events are
+ * queued.
+ */
+static absolute_time_t output_task(absolute_time_t now) {
+  print_events();
+  return at_the_end_of_time;
+}
+
+/**
+ * @brief Returns the state the alert LEDs should show: LED0 while any sensor
+ * is at or above its firmware warning threshold, and LED1 while any sensor
+ * is critical or the hardware ALERT is asserted.
+ *
+ * @return The LED0 state in bit 0 and the LED1 state in bit 1.
+ */
+static uint alert_led_state() {
+  bool has_alert_N = !gpio_get(ALERT_GP);
+  uint8_t level = alert_highest_level();
+  return (level >= ALERT_WARNING) |
+         ((has_alert_N || level == ALERT_CRITICAL) << 1);
+}
+
+/**
+ * @brief Sends buffered console output to the host as fast as USB takes it.
+ *
+ * @param now The time the task was started.
+ *
+ * @return The time of the next attempt while the host is not keeping up,
+ * otherwise at_the_end_of_time until more output is written.
+ */
+static absolute_time_t console_task(absolute_time_t now) {
+  if (console_drain()) {
+    return delayed_by_ms(now, CONSOLE_DRAIN_MS);
+  }
+  return at_the_end_of_time;
+}
+
+// State last written to the alert LEDs.
+static uint led_state = 0;
+
+/**
+ * @brief Returns whether the alert LEDs are out of date. ALERT edges and
+ * alert level changes both wake core0, so this is checked on every pass.
+ *
+ * @return true if the LED task should run now.
+ */
+static bool led_ready() { return alert_led_state() != led_state; }
+
+/**
+ * @brief Updates the alert LEDs.
+ *
+ * @param now The time the task was started.
+ *
+ * @return at_the_end_of_time, since the task only runs on changes.
+ */
+static absolute_time_t led_task(absolute_time_t now) {
+  led_state = alert_led_state();
+  gpio_put(LED0, led_state & 1);
+  gpio_put(LED1, (led_state >> 1) & 1);
+  return at_the_end_of_time;
+}
+
+// Tasks of the core0 event loop, run in this order when due.
+static Task tasks[] = {
+    {.name = "sample", .run = sample_task, .is_ready = sample_ready},
+    {.name = "alert", .run = alert_task, .is_ready = alert_ready},
+    {.name = "oversample", .run = oversample_task},
+    {.name = "output", .run = output_task, .is_ready = event_pending},
+    {.name = "leds", .run = led_task, .is_ready = led_ready},
+    {.name = "console", .run = console_task, .is_ready = console_pending},
+    {.name = "heartbeat", .run = heartbeat_task},
+    {.name = "usb", .run = usb_task},
+};
+
 // Define the main function.
 int main() {
-  // Initialize the standard input and output for the program.
-  stdio_init_all();
+  // Paint the free stack so its high-water mark can be reported.
+  stack_paint_core0();
   // Set up the GPIO pins used by the project.
   set_gpio(proj_gpio, NUMBER_OF_GPIOS);
+  // Initialize the I2C buses used by the project at their baud rate.
+  set_i2c(proj_i2c, NUMBER_OF_I2C);
+  // Start the PIO I2C master for sensors beyond the hardware controllers.
+  pio_i2c_init(&proj_pio_i2c);
+  // Identify the part on every sensor address.
+  sensor_driver_detect(proj_sensors, NUMBER_OF_SENSORS);
+  // Take the first sample before anything else and hold it until a host
+  // connects. It is filtered, logged and checked once those are set up.
+  poll_sensors(proj_sensors, NUMBER_OF_SENSORS, active_sensors, samples);
+  uint32_t first_mask = valid_sample_mask(active_sensors);
+  fast_boot_record(samples, NUMBER_OF_SENSORS, first_mask);
+  // Initialize the standard input and output for the program. USB comes up
+  // in the background; nothing waits for a host.
+  stdio_init_all();
+  // Buffer stdout per core so printing never waits for the host; the console
+  // task sends it on.
+  console_init();
   // Enable interrupts for the GPIO pins.
   enable_irq(proj_gpio, NUMBER_OF_GPIOS);
   // Set up a callback function to be called when a GPIO interrupt occurs.
   gpio_set_irq_callback(&gpio_callback);
-  // Initialize the I2C communication protocol with a specific baud rate.
-  i2c_init(i2c, TCN75A_BAUDRATE);
-  // Set up the I2C device(s) used by the project.
-  set_i2c(proj_i2c, NUMBER_OF_I2C);
-  // Launch a second core to run a separate function.
-  multicore_launch_core1(core1_entry);
-  // Print the current temperature using the I2C communication protocol and
-  // device address.
-  print_ambient_temperature(i2c, dev_addr);
-  // Loop indefinitely.
-  while (1) {
-    // If a request is received through the multicore FIFO, act on it.
-    if (multicore_fifo_rvalid()) {
-      // Get the request value from the FIFO.
-      uint32_t request = multicore_fifo_pop_blocking();
-      // If the request is to disable interrupts, do so.
-      if (request == DISABLE_IRQ) {
-        disable_irq(proj_gpio, NUMBER_OF_GPIOS);
-      }
-      // If the request is to enable interrupts, do so.
-      else if (request == ENABLE_IRQ) {
-        enable_irq(proj_gpio, NUMBER_OF_GPIOS);
-      }
-    }
-    // If temperature reading is enabled, print the current temperature.
-    if (enable_read_temp) {
-      print_ambient_temperature(i2c, dev_addr);
-    }
-    // Turn on the onboard LED.
-    gpio_put(ONBOARD_LED, 1);
-    // Sleep for a set amount of time.
-    sleep_ms(BLINK_LED_DELAY);
-    // Turn off the onboard LED.
-    gpio_put(ONBOARD_LED, 0);
-    // Sleep for a set amount of time.
-    sleep_ms(BLINK_LED_DELAY);
+  // Timestamp the button and ALERT edges in hardware as well.
+  edge_capture_init();
+  // Apply the boot profile from flash, if any. Bus clocks tuned on demand
+  // are kept in the profile rather than tuned on every boot.
+  profile_apply_at_boot();
+  // Validate the register shadow cache of every sensor against the devices.
+  reg_cache_load_all(proj_sensors, NUMBER_OF_SENSORS);
+  // Treat the ALERT edge matching the sensors' polarity as an assertion.
+  SensorConfig alert_sensor = {.i2c_inst = i2c, .addr = dev_addr};
+  uint8_t alert_config;
+  if (reg_cache_read_config(&alert_sensor, &alert_config)) {
+    alert_irq_set_polarity(alert_config & ALERT_POLARITY_MASK);
+  }
+#ifdef BENCHMARK
+  // Compare the I2C paths before the UI takes over the console. The console
+  // discards output until a host opens the port, so wait for one first.
+  while (!fast_boot_usb_ready()) {
+    sleep_ms(FAST_BOOT_USB_POLL_MS);
   }
+  run_benchmarks();
+#endif
+  // Find the write position of the on-flash sample log.
+  sample_log_init();
+  // Start with an empty in-RAM history.
+  history_init();
+  // Arm the firmware alert thresholds and trend detectors of every sensor.
+  alert_engine_init();
+  trend_init();
+  // Process the first sample like every later one.
+  process_samples(first_mask);
+  // Launch a second core to run a separate function, on a painted stack.
+  stack_paint_core1();
+  multicore_launch_core1(core1_entry);
+  // Run the sampling, ALERT, output, console, heartbeat and USB tasks and the
+  // requests from core1 forever, sleeping until the next deadline or event.
+  // The USB task prints the latest samples once a host connects.
+  event_loop_run(tasks, count_of(tasks));
 }
@@ -0,0 +1,279 @@
+#include "config.h"
+#include "reg_cache.h"
+#include "sensor_driver.h"
+#include "tcn75a.h"
+
+// MCP9808 registers.
+#define MCP9808_CONFIG_REG 0x01
+#define MCP9808_UPPER_REG 0x02
+#define MCP9808_LOWER_REG 0x03
+#define MCP9808_CRIT_REG 0x04
+#define MCP9808_TEMP_REG 0x05
+#define MCP9808_MANUFACTURER_REG 0x06
+#define MCP9808_DEVICE_REG 0x07
+#define MCP9808_RESOLUTION_REG 0x08
+
+// Contents of the ID registers, the device ID in the high byte.
+#define MCP9808_MANUFACTURER_ID 0x0054
+#define MCP9808_DEVICE_ID 0x04
+
+// Config register fields: ALERT hysteresis, shutdown, ALERT output enable,
+// ALERT polarity and ALERT mode.
+#define MCP9808_HYST_MASK 0x0600
+#define MCP9808_HYST_SHIFT 9
+#define MCP9808_SHUTDOWN_SHIFT 8
+#define MCP9808_ALERT_ENABLE_MASK 0x0008
+#define MCP9808_POLARITY_SHIFT 1
+#define MCP9808_MODE_SHIFT 0
+// Temperature register value, 0.0625 C per bit with the sign in bit 12.
+#define MCP9808_TEMP_MASK 0x1FFF
+#define MCP9808_SIGN_BIT 0x1000
+// Resolution register field, 0 (0.5 C) to 3 (0.0625 C, the power-on value).
+#define MCP9808_RESOLUTION_MASK 0b11
+#define MCP9808_DEFAULT_RESOLUTION 3
+// Bits implemented by the limit registers (0.25 C resolution).
+#define MCP9808_LIMIT_MASK 0x1FFC
+// Bottom of the operating range, used as the lower window limit.
+#define MCP9808_MIN_C (-40)
+
+// Typical conversion time of each resolution, in ms.
+static const uint8_t conversion_times_ms[] = {30, 65, 130, 250};
+// Hysteresis settings of the config register, in 1/256 C.
+static const int16_t hyst_steps[] = {0, 384, 768, 1536};
+
+/**
+ * @brief Checks whether the device at a sensor's address is an MCP9808.
+ *
+ * @param sensor A pointer to the sensor to probe.
+ *
+ * @return true if the manufacturer and device ID registers match, false
+ * otherwise.
+ */
+static bool mcp9808_probe(const SensorConfig *sensor) {
+  uint16_t manufacturer;
+  uint16_t device;
+  return sensor_driver_read_word(sensor, MCP9808_MANUFACTURER_REG,
+                                 &manufacturer) == 2 &&
+         manufacturer == MCP9808_MANUFACTURER_ID &&
+         sensor_driver_read_word(sensor, MCP9808_DEVICE_REG, &device) == 2 &&
+         (device >> 8) == MCP9808_DEVICE_ID;
+}
+
+/**
+ * @brief Returns the ADC resolution of an MCP9808 from the register cache.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The resolution in bits, 9 to 12.
+ */
+static uint8_t mcp9808_resolution(const SensorConfig *sensor) {
+  // The power-on resolution is 12 bits.
+  uint8_t conf =
+      config_field_encode(ADC_RESOLUTION_FIELD, MCP9808_DEFAULT_RESOLUTION);
+  reg_cache_read_config(sensor, &conf);
+  return 9 + config_field_get(conf, ADC_RESOLUTION_FIELD);
+}
+
+/**
+ * @brief Returns the typical conversion time of an MCP9808.
+ *
+ * @param bits The resolution in bits, 9 to 12.
+ *
+ * @return The conversion time in milliseconds.
+ */
+static uint32_t mcp9808_conversion_ms(uint8_t bits) {
+  return conversion_times_ms[(bits - 9) & MCP9808_RESOLUTION_MASK];
+}
+
+/**
+ * @brief Configures an MCP9808 from a config value in the
+ * TCN75A_CONFIG_FIELDS layout.
+ *
+ * Shutdown, ALERT mode and ALERT polarity map to bits of the MCP9808 config
+ * register, whose other bits are kept, and the ADC resolution field to the
+ * resolution register, which uses the same encoding. The MCP9808 has no
+ * fault queue or one-shot mode, so those fields are dropped.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param conf The config value.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a read or write failed.
+ */
+static int mcp9808_configure(const SensorConfig *sensor, uint8_t conf) {
+  uint16_t reg;
+  int ret = sensor_driver_read_word(sensor, MCP9808_CONFIG_REG, &reg);
+  if (ret != 2) {
+    return ret < 0 ? ret : PICO_ERROR_GENERIC;
+  }
+  reg &= ~((1u << MCP9808_SHUTDOWN_SHIFT) | (1u << MCP9808_POLARITY_SHIFT) |
+           (1u << MCP9808_MODE_SHIFT));
+  reg |= (config_field_get(conf, SHUTDOWN_FIELD) << MCP9808_SHUTDOWN_SHIFT) |
+         (config_field_get(conf, ALERT_POLARITY_FIELD)
+          << MCP9808_POLARITY_SHIFT) |
+         (config_field_get(conf, ALERT_MODE_FIELD) << MCP9808_MODE_SHIFT);
+  ret = sensor_driver_write_word(sensor, MCP9808_CONFIG_REG, reg);
+  if (ret >= 0) {
+    uint8_t res[1] = {config_field_get(conf, ADC_RESOLUTION_FIELD)};
+    ret = sensor_reg_write(sensor, MCP9808_RESOLUTION_REG, res, 1);
+  }
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the config and resolution registers of an MCP9808 into a
+ * config value in the TCN75A_CONFIG_FIELDS layout.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param conf A pointer that receives the config value, with the fault queue
+ * and one-shot fields clear.
+ *
+ * @return true if both registers were read, false otherwise.
+ */
+static bool mcp9808_read_config(const SensorConfig *sensor, uint8_t *conf) {
+  uint16_t reg;
+  uint8_t res;
+  if (sensor_driver_read_word(sensor, MCP9808_CONFIG_REG, &reg) != 2 ||
+      sensor_reg_read(sensor, MCP9808_RESOLUTION_REG, &res, 1) != 1) {
+    return false;
+  }
+  *conf = config_field_encode(SHUTDOWN_FIELD,
+                              (reg >> MCP9808_SHUTDOWN_SHIFT) & 1) |
+          config_field_encode(ALERT_POLARITY_FIELD,
+                              (reg >> MCP9808_POLARITY_SHIFT) & 1) |
+          config_field_encode(ALERT_MODE_FIELD,
+                              (reg >> MCP9808_MODE_SHIFT) & 1) |
+          config_field_encode(ADC_RESOLUTION_FIELD,
+                              res & MCP9808_RESOLUTION_MASK);
+  return true;
+}
+
+/**
+ * @brief Reads the ambient temperature register of an MCP9808.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param raw A pointer that receives the register value.
+ *
+ * @return The number of bytes read, or a PICO_ERROR code.
+ */
+static int mcp9808_read_raw(const SensorConfig *sensor, uint16_t *raw) {
+  return sensor_driver_read_word(sensor, MCP9808_TEMP_REG, raw);
+}
+
+/**
+ * @brief Converts an MCP9808 ambient temperature register value to 1/256 C.
+ *
+ * The top three bits hold the window comparator flags and are dropped. Values
+ * beyond the range of a sample saturate.
+ *
+ * @param raw The register value.
+ *
+ * @return The temperature in 1/256 C.
+ */
+static int16_t HOT_PATH_FUNC(mcp9808_convert)(uint16_t raw) {
+  int32_t value = raw & MCP9808_TEMP_MASK;
+  if (value & MCP9808_SIGN_BIT) {
+    value -= 2 * MCP9808_SIGN_BIT;
+  }
+  value *= 16;
+  if (value > INT16_MAX) {
+    return INT16_MAX;
+  }
+  return value < INT16_MIN ? INT16_MIN : (int16_t)value;
+}
+
+/**
+ * @brief Encodes a temperature for an MCP9808 limit register.
+ *
+ * @param value The temperature in 1/256 C.
+ *
+ * @return The register value.
+ */
+static uint16_t encode_limit(int16_t value) {
+  return (uint16_t)(value >> 4) & MCP9808_LIMIT_MASK;
+}
+
+/**
+ * @brief Sets up the ALERT output of an MCP9808.
+ *
+ * The MCP9808 compares against a window rather than a single limit, so the
+ * upper and critical limits are set to set and the lower limit to the bottom
+ * of the operating range. Its hysteresis is a config register field with four
+ * settings, of which the largest that does not exceed set - hyst is used.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param hyst The temperature below which ALERT releases, in 1/256 C.
+ * @param set The temperature above which ALERT asserts, in 1/256 C.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a read or write failed.
+ */
+static int mcp9808_alert_config(const SensorConfig *sensor, int16_t hyst,
+                                int16_t set) {
+  uint16_t conf;
+  int ret = sensor_driver_read_word(sensor, MCP9808_CONFIG_REG, &conf);
+  if (ret != 2) {
+    return ret < 0 ? ret : PICO_ERROR_GENERIC;
+  }
+
+  uint16_t step = 0;
+  while (step + 1 < count_of(hyst_steps) &&
+         (int32_t)set - hyst >= hyst_steps[step + 1]) {
+    step++;
+  }
+  conf &= ~MCP9808_HYST_MASK;
+  conf |= (step << MCP9808_HYST_SHIFT) | MCP9808_ALERT_ENABLE_MASK;
+
+  const uint8_t regs[] = {MCP9808_UPPER_REG, MCP9808_CRIT_REG,
+                          MCP9808_LOWER_REG};
+  const uint16_t values[] = {encode_limit(set), encode_limit(set),
+                             encode_limit(MCP9808_MIN_C * 256)};
+  for (size_t i = 0; i < count_of(regs) && ret >= 0; i++) {
+    ret = sensor_driver_write_word(sensor, regs[i], values[i]);
+  }
+  if (ret >= 0) {
+    ret = sensor_driver_write_word(sensor, MCP9808_CONFIG_REG, conf);
+  }
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the ALERT limits of an MCP9808 back as set by
+ * mcp9808_alert_config.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param hyst A pointer that receives the upper limit less the hysteresis,
+ * in 1/256 C.
+ * @param set A pointer that receives the upper limit in 1/256 C.
+ *
+ * @return true if the registers were read, false otherwise.
+ */
+static bool mcp9808_read_alert(const SensorConfig *sensor, int16_t *hyst,
+                               int16_t *set) {
+  uint16_t conf;
+  uint16_t upper;
+  if (sensor_driver_read_word(sensor, MCP9808_CONFIG_REG, &conf) != 2 ||
+      sensor_driver_read_word(sensor, MCP9808_UPPER_REG, &upper) != 2) {
+    return false;
+  }
+  *set = mcp9808_convert(upper);
+  *hyst = *set - hyst_steps[(conf & MCP9808_HYST_MASK) >> MCP9808_HYST_SHIFT];
+  return true;
+}
+
+const SensorDriver mcp9808_driver = {.name = "MCP9808",
+                                     .first_addr = 0x18,
+                                     .last_addr = 0x1F,
+                                     .max_baudrate = 400 * 1000,
+                                     .temp_reg = MCP9808_TEMP_REG,
+                                     .config_mask = SHUTDOWN_MASK |
+                                                    ALERT_MODE_MASK |
+                                                    ALERT_POLARITY_MASK |
+                                                    ADC_RESOLUTION_MASK,
+                                     .probe = mcp9808_probe,
+                                     .resolution = mcp9808_resolution,
+                                     .conversion_ms = mcp9808_conversion_ms,
+                                     .configure = mcp9808_configure,
+                                     .read_config = mcp9808_read_config,
+                                     .read_raw = mcp9808_read_raw,
+                                     .convert = mcp9808_convert,
+                                     .alert_config = mcp9808_alert_config,
+                                     .read_alert = mcp9808_read_alert};
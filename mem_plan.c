@@ -0,0 +1,130 @@
+#include "mem_plan.h"
+
+#include <stdio.h>
+
+#include "event_queue.h"
+#include "history.h"
+#include "oversample.h"
+#include "profile.h"
+#include "reg_cache.h"
+#include "sample_log.h"
+
+uint8_t i2c_msg_pool[NUM_CORES][I2C_MAX_REG_BYTES + 1];
+char menu_input[MENU_INPUT_LEN];
+
+// Every statically allocated buffer larger than a few words, sized from
+// config.h. Resize the history or the buffers here and the build fails if
+// the plan no longer fits in RAM_BUDGET_BYTES.
+#define HISTORY_POOL_BYTES                                                     \
+  (NUMBER_OF_SENSORS *                                                         \
+   (sizeof(SensorHistory) +                                                    \
+    (HISTORY_SECONDS + HISTORY_MINUTES + HISTORY_HOURS) *                      \
+        sizeof(HistoryRollup)))
+#define RAM_PLAN_BYTES                                                         \
+  (HISTORY_POOL_BYTES + NUM_CORES * CONSOLE_BUFFER_BYTES +                     \
+   FAST_BOOT_BUFFER_LEN * sizeof(LogRecord) + 2 * FLASH_PAGE_SIZE +            \
+   PROFILE_STORE_BYTES + EVENT_QUEUE_LEN * sizeof(Event) +                     \
+   2 * (1u << EDGE_CAPTURE_RING_BITS) +                                        \
+   REG_CACHE_ENTRIES * sizeof(RegCacheEntry) +                                 \
+   NUMBER_OF_SENSORS * sizeof(Oversampler) + sizeof(i2c_msg_pool) +            \
+   sizeof(menu_input))
+
+_Static_assert(RAM_PLAN_BYTES <= RAM_BUDGET_BYTES,
+               "static buffers exceed RAM_BUDGET_BYTES");
+
+static const RamPool ram_pools[] = {
+    {"history", HISTORY_POOL_BYTES},
+    {"console", NUM_CORES * CONSOLE_BUFFER_BYTES},
+    {"boot buffer", FAST_BOOT_BUFFER_LEN * sizeof(LogRecord)},
+    {"log pages", 2 * FLASH_PAGE_SIZE},
+    {"profile staging", PROFILE_STORE_BYTES},
+    {"events", EVENT_QUEUE_LEN * sizeof(Event)},
+    {"edge rings", 2 * (1u << EDGE_CAPTURE_RING_BITS)},
+    {"register cache", REG_CACHE_ENTRIES * sizeof(RegCacheEntry)},
+    {"oversamplers", NUMBER_OF_SENSORS * sizeof(Oversampler)},
+    {"i2c messages", sizeof(i2c_msg_pool)},
+    {"menu input", sizeof(menu_input)},
+};
+
+// Stack bounds from the SDK linker script. core0 runs on the SCRATCH_Y stack
+// and multicore_launch_core1 gives core1 the SCRATCH_X stack.
+extern uint32_t __StackBottom[], __StackTop[];
+extern uint32_t __StackOneBottom[], __StackOneTop[];
+
+/**
+ * @brief Fills part of a stack with STACK_PAINT_WORD. Written as a plain
+ * loop, since a call to memset would use the stack being painted.
+ *
+ * @param from The lowest word to paint.
+ * @param to The word after the last one to paint.
+ *
+ * @return None.
+ */
+static void paint(uint32_t *from, uint32_t *to) {
+  for (volatile uint32_t *word = from; word < to; word++) {
+    *word = STACK_PAINT_WORD;
+  }
+}
+
+/**
+ * @brief Paints the unused part of the core0 stack. Must be called first
+ * thing in main, while the stack is still shallow.
+ *
+ * @return None.
+ */
+void stack_paint_core0() {
+  uint32_t here;
+  paint(__StackBottom, &here - STACK_PAINT_MARGIN_WORDS);
+}
+
+/**
+ * @brief Paints the whole core1 stack. Must be called before core1 is
+ * launched.
+ *
+ * @return None.
+ */
+void stack_paint_core1() { paint(__StackOneBottom, __StackOneTop); }
+
+/**
+ * @brief Returns the deepest stack use of a core since it was painted, found
+ * as the lowest word that no longer holds STACK_PAINT_WORD.
+ *
+ * @param core 0 or 1.
+ *
+ * @return The number of bytes used, or the whole stack size if it was
+ * exhausted.
+ */
+uint32_t stack_high_water(uint core) {
+  uint32_t *bottom = core == 0 ? __StackBottom : __StackOneBottom;
+  uint32_t *top = core == 0 ? __StackTop : __StackOneTop;
+  uint32_t *word = bottom;
+  while (word < top && *word == STACK_PAINT_WORD) {
+    word++;
+  }
+  return (top - word) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Prints the static RAM plan against RAM_BUDGET_BYTES and the stack
+ * high-water mark of both cores.
+ *
+ * @return None.
+ */
+void print_memory_plan() {
+  printf("\nRAM plan:\n");
+  for (uint i = 0; i < count_of(ram_pools); i++) {
+    printf("%-16s %6lu bytes\n", ram_pools[i].name,
+           (unsigned long)ram_pools[i].bytes);
+  }
+  printf("%-16s %6lu of %d bytes\n", "total", (unsigned long)RAM_PLAN_BYTES,
+         RAM_BUDGET_BYTES);
+  for (uint core = 0; core < NUM_CORES; core++) {
+    uint32_t *bottom = core == 0 ? __StackBottom : __StackOneBottom;
+    uint32_t *top = core == 0 ? __StackTop : __StackOneTop;
+    uint32_t size = (top - bottom) * sizeof(uint32_t);
+    uint32_t used = stack_high_water(core);
+    printf("core%u stack: %lu of %lu bytes used at most%s\n", core,
+           (unsigned long)used, (unsigned long)size,
+           used == size ? " (EXHAUSTED)" : "");
+  }
+}
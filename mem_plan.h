@@ -0,0 +1,25 @@
+#ifndef __MEM_PLAN_H__
+#define __MEM_PLAN_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+// Struct for storing one entry of the static RAM plan
+// name the name of the buffer
+// bytes the size of the buffer
+typedef struct {
+  const char *name;
+  uint32_t bytes;
+} RamPool;
+
+// Scratch buffers that used to live on the stack. Each core has its own
+// I2C message buffer; the menu input buffer is only used by core1.
+extern uint8_t i2c_msg_pool[NUM_CORES][I2C_MAX_REG_BYTES + 1];
+extern char menu_input[MENU_INPUT_LEN];
+
+void stack_paint_core0();
+void stack_paint_core1();
+uint32_t stack_high_water(uint core);
+void print_memory_plan();
+
+#endif
@@ -1,11 +1,17 @@
 #include "menu_handler.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "config.h"
+#include "filter.h"
 #include "hardware/address_mapped.h"
 #include "i2c_util.h"
+#include "mem_plan.h"
+#include "profile.h"
 #include "pico/time.h"
+#include "tcn75a.h"
 #include "util.h"
 
 /**
@@ -29,160 +35,118 @@ void show_landing_page() {
   printf(" ------------------------------------------ \n");
 }
 
+/**
+ * @brief Stages one config field change in a pending menu result.
+ *
+ * @param pending The menu result staged so far.
+ * @param shift The *_SHIFT flag of the field.
+ * @param mask The *_MASK of the field.
+ * @param value The new field value, already in register position.
+ *
+ * @return The updated menu result.
+ */
+static uint32_t stage_config(uint32_t pending, uint32_t shift, uint8_t mask,
+                             uint8_t value) {
+  return (pending & ~(uint32_t)mask) | shift | value;
+}
+
+/**
+ * @brief Displays the values of one config register field and stages the
+ * selected one.
+ *
+ * Only values the field can hold are accepted.
+ *
+ * @param pending The menu result staged so far.
+ * @param field The index of the field in config_fields.
+ *
+ * @return The updated menu result, unchanged if the user returns to main.
+ */
+static uint32_t show_field_menu(uint32_t pending, size_t field) {
+  const ConfigField *f = &config_fields[field];
+  uint8_t n_values = config_field_values(field);
+  char option;
+  while (1) {
+    clear_screen();
+    printf("%s\n", f->label);
+    for (uint8_t v = 0; v < n_values; v++) {
+      printf("[%u] %s\n", v, f->value_names[v]);
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option >= '0' && option < '0' + n_values) {
+      return stage_config(pending, f->menu_flag, f->mask,
+                          config_field_encode(field, option - '0'));
+    } else if (option == 'x') {
+      return pending;
+    }
+  }
+}
+
 /**
 
     @brief Displays a configuration menu for the temperature sensor and returns
    the selected configuration. The function displays a menu with several
    configuration options for the temperature sensor. The user can select an
-   option by entering the corresponding number or letter on the keyboard. If the
-   user selects an option that requires further configuration, such as the
-   SHUTDOWN Setting or COMP/INT Select options, the function displays a sub-menu
-   with additional configuration options. Once the user has made their
-   selections, the function returns a 32-bit integer that encodes the selected
-   configuration options using bit shifting and bitwise OR operations.
+   option by entering the corresponding number or letter on the keyboard. The
+   config register fields and their sub-menus are rendered from config_fields,
+   so selecting one, such as Shutdown or Alert Mode, lists the values that
+   field can take. Selections are staged rather than
+   returned one at a time, so several fields can be changed in one visit. When
+   the user chooses to write, the function returns a 32-bit integer that
+   encodes every staged option using bit shifting and bitwise OR operations,
+   with APPLY_ALL_SHIFT set if the change targets all sensors.
     @return A 32-bit integer that encodes the selected configuration options.
     
     0b0000_0000_0000_0000_0000_0000_0000_0000
     No change flag: 0b0000_0000_0000_0001_0000_0000_0000_0000
     Shutdown flag: 0b1000_0000_0000_0000_0000_0000_0000_0000
     COMP/INT flag: 0b0100_0000_0000_0000_0000_0000_0000_0000
+    Apply-all flag: 0b0000_0010_0000_0000_0000_0000_0000_0000
 
 
     */
 uint32_t show_config_menu() {
   char option;
+  uint32_t pending = 0;
   while (1) {
     clear_screen();
-    printf("[0] SHUTDOWN Setting\n");
-    printf("[1] COMP/INT Select\n");
-    printf("[2] ALERT POLARITY\n");
-    printf("[3] FAULT QUEUE\n");
-    printf("[4] ADC RES\n");
-    printf("[5] ONE-SHOT\n");
+    printf("Staged changes: %d\n", __builtin_popcount(pending & ~0xFFu));
+    for (size_t i = 0; i < NUMBER_OF_CONFIG_FIELDS; i++) {
+      printf("[%u] %s\n", (unsigned)i, config_fields[i].label);
+    }
+    printf("[p] PROFILES\n");
+    printf("[l] SAMPLE LOG\n");
+    printf("[h] HISTORY\n");
+    printf("[f] FILTERS\n");
+    printf("[o] OVERSAMPLING\n");
+    printf("[r] ADAPTIVE RATE\n");
+    printf("[w] WRITE to current sensor\n");
+    printf("[a] WRITE to all sensors\n");
     printf("[x] QUIT\n");
     scanf(" %c", &option);
 
-    if (option == '0') {
-      while (1) {
-        clear_screen();
-        printf("SHUTDOWN Setting\n");
-        printf("[0] Disable Shutdown\n");
-        printf("[1] Enable Shutdown\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          // Disabling shutdown
-          return SHUTDOWN_MODE_SHIFT | (0b00000000);
-
-        } else if (option == '1') {
-          // Enabling shutdown
-          return SHUTDOWN_MODE_SHIFT | (0b00000001);
-        } else if (option == 'x') {
-          break;
-        }
-      }
-    } else if (option == '1') {
-      while (1) {
-        clear_screen();
-        printf("COMP/INT Select\n");
-        printf("[0] Comparator mode\n");
-        printf("[1] Interrupt mode\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          return COMP_INT_MODE_SHIFT | (0b00000000);
-        } else if (option == '1') {
-          return COMP_INT_MODE_SHIFT | (0b00000010);
-        } else if (option == 'x') {
-          break;
-        }
-      }
-    } else if (option == '2') {
-      while (1) {
-        clear_screen();
-        printf("Alert Polarity\n");
-        printf("[0] Active low\n");
-        printf("[1] Active High\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          // Active Low selected
-          return ALERT_POLARITY_SHIFT | (0b00000000);
-        } else if (option == '1') {
-          // Active High selected
-          return ALERT_POLARITY_SHIFT | (0b00000100);
-        } else if (option == 'x') {
-          break;
-        }
-      }
-    } else if (option == '3') {
-      while (1) {
-        clear_screen();
-        printf("Fault Queue\n");
-        printf("[0] 00\n");
-        printf("[1] 01\n");
-        printf("[2] 10\n");
-        printf("[3] 11\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          return FAULT_QUEUE_MODE_SHIFT | (0b00000000);
-        } else if (option == '1') {
-          return FAULT_QUEUE_MODE_SHIFT | (0b00001000);
-        } else if (option == '2') {
-          return FAULT_QUEUE_MODE_SHIFT | (0b00010000);
-        } else if (option == '3') {
-          return FAULT_QUEUE_MODE_SHIFT | (0b00011000);
-        } else if (option == 'x') {
-          break;
-        }
-      }
-    } else if (option == '4') {
-      while (1) {
-        clear_screen();
-        printf("ADC Resolution\n");
-        printf("[0] 9 bit or 0.5C\n");
-        printf("[1] 10 bit or 0.25C\n");
-        printf("[2] 11 bit or 0.125C\n");
-        printf("[3] 12 bit or 0.0625C\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          return ADC_RESOLUTION_SHIFT | (0b00000000);
-        } else if (option == '1') {
-          return ADC_RESOLUTION_SHIFT | (0b00100000);
-        } else if (option == '2') {
-          return ADC_RESOLUTION_SHIFT | (0b01000000);
-        } else if (option == '3') {
-          return ADC_RESOLUTION_SHIFT | (0b01100000);
-        } else if (option == 'x') {
-          break;
-        }
-      }
-    } else if (option == '5') {
-      while (1) {
-        clear_screen();
-        printf("One SHOT setting\n");
-        printf("[0] Disable\n");
-        printf("[1] Enable\n");
-        printf("[x] Return to main\n");
-        scanf(" %c", &option);
-
-        if (option == '0') {
-          return ONE_SHOT_MODE_SHIFT | (0b00000000);
-        } else if (option == '1') {
-          return ONE_SHOT_MODE_SHIFT | (0b10000000);
-        } else if (option == 'x') {
-          break;
-        }
+    if (option >= '0' && option < '0' + NUMBER_OF_CONFIG_FIELDS) {
+      pending = show_field_menu(pending, option - '0');
+    } else if (option == 'p') {
+      return PROFILE_MENU_SHIFT;
+    } else if (option == 'l') {
+      return LOG_MENU_SHIFT;
+    } else if (option == 'h') {
+      return HISTORY_MENU_SHIFT;
+    } else if (option == 'f') {
+      return FILTER_MENU_SHIFT;
+    } else if (option == 'o') {
+      return OVERSAMPLE_MENU_SHIFT;
+    } else if (option == 'r') {
+      return ADAPTIVE_MENU_SHIFT;
+    } else if (option == 'w' || option == 'a') {
+      if (pending == 0) {
+        return NO_CHANGE_SHIFT;
       }
+      return option == 'a' ? (pending | APPLY_ALL_SHIFT) : pending;
     } else if (option == 'x') {
-      return (1 << 16);
+      return NO_CHANGE_SHIFT;
     }
   }
 }
@@ -276,15 +240,17 @@ uint32_t show_alert_menu(uint8_t *buf) {
     printf("[1] Write Temp Set Limit\n");
     printf("[2] Show Temp Hyst Limit\n");
     printf("[3] Show Temp Set Limit\n");
+    printf("[4] Sensor Alert Thresholds\n");
+    printf("[5] Sensor Trend Threshold\n");
     printf("[x] Return to main\n");
     scanf(" %c", &option);
 
     if (option == '0') {
-      char input[8];
+      char *input = menu_input;
       int32_t output[2];
       clear_screen();
       printf("Enter Temp Hyst Limit: ");
-      get_input(input, 8);
+      get_input(input, MENU_INPUT_LEN);
       bool is_success = str_to_fixed_point(input, output);
       if (is_success) {
         buf[0] = output[0];
@@ -295,11 +261,11 @@ uint32_t show_alert_menu(uint8_t *buf) {
         sleep_ms(2000);
       }
     } else if (option == '1') {
-      char input[8];
+      char *input = menu_input;
       int32_t output[2];
       clear_screen();
       printf("Enter Temp Set Limit: ");
-      get_input(input, 8);
+      get_input(input, MENU_INPUT_LEN);
       bool is_success = str_to_fixed_point(input, output);
       if (is_success) {
         buf[0] = output[0];
@@ -313,6 +279,10 @@ uint32_t show_alert_menu(uint8_t *buf) {
       return READ_TEMP_HYST_LIMIT;
     } else if (option == '3') {
       return READ_TEMP_SET_LIMIT;
+    } else if (option == '4') {
+      return EDIT_SENSOR_THRESHOLDS;
+    } else if (option == '5') {
+      return EDIT_TREND_THRESHOLD;
     } else if (option == 'x') {
       clear_screen();
       break;
@@ -322,81 +292,419 @@ uint32_t show_alert_menu(uint8_t *buf) {
 }
 
 /**
-  @brief Parses a 32-bit integer that encodes temperature sensor configuration
-  settings and prints them to the console. The function takes a 32-bit integer
-  as input that encodes temperature sensor configuration settings. It then
-  parses the integer and prints the settings in a formatted table to the
-  console. The table includes settings for Shutdown, Alert Mode, Alert Polarity,
-  Fault Queue, ADC Resolution, and One-Shot. If a configuration setting is
-  unknown, the function prints 'UNKNOWN' in the Value column of the table.
-  @param conf A 32-bit integer that encodes the temperature sensor configuration
-  settings.
+  @brief Displays a menu for managing the configuration profiles stored in
+   flash and returns the selected action. Saving, loading and selecting the
+   boot profile all prompt for a slot number, and saving also prompts for a
+   profile name. Tuning the bus clocks changes the current settings only, so
+   a profile must be saved to keep them. If the user selects 'x', the
+   function returns without modifying the slot or the name.
+  @param slot A pointer that receives the selected profile slot.
+  @param name A buffer of PROFILE_NAME_LEN characters that receives the name
+   of a profile being saved.
+  @return An integer that encodes the selected profile action.
 */
-void parse_config(uint8_t conf) {
-  printf("+--------------------+--------------+\n");
-  printf("|       Setting      |     Value    |\n");
-  printf("+--------------------+--------------+\n");
-  printf("| %-18s | ", "Shutdown:");
-  if ((conf & SHUTDOWN_MASK) == 0) {
-    printf("%-12s |\n", "Disable");
-  } else if ((conf & SHUTDOWN_MASK) == SHUTDOWN_MASK) {
-    printf("%-12s |\n", "Enable");
-  } else {
-    printf("%-12s |\n", "UNKNOWN");
+uint32_t show_profile_menu(uint8_t *slot, char *name) {
+  char option;
+  while (1) {
+    clear_screen();
+    printf("Profiles\n");
+    print_profiles();
+    printf("[0] Save current settings\n");
+    printf("[1] Load profile\n");
+    printf("[2] Apply profile at boot\n");
+    printf("[3] Boot with sensor defaults\n");
+    printf("[4] Tune bus clocks\n");
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == '3') {
+      return PROFILE_CLEAR_BOOT;
+    } else if (option == '4') {
+      return PROFILE_TUNE_BUSES;
+    } else if (option == '0' || option == '1' || option == '2') {
+      char slot_option;
+      printf("Slot [0-%d]: ", NUMBER_OF_PROFILES - 1);
+      scanf(" %c", &slot_option);
+      if (slot_option < '0' || slot_option >= '0' + NUMBER_OF_PROFILES) {
+        printf("Invalid slot! Returning to the previous menu\n");
+        sleep_ms(2000);
+        continue;
+      }
+      *slot = slot_option - '0';
+      if (option == '1') {
+        return PROFILE_LOAD;
+      } else if (option == '2') {
+        return PROFILE_SET_BOOT;
+      }
+      printf("\nEnter profile name: ");
+      get_input(name, PROFILE_NAME_LEN);
+      return PROFILE_SAVE;
+    } else if (option == 'x') {
+      clear_screen();
+      return PROFILE_NO_CHANGE;
+    }
   }
+}
 
-  printf("| %-18s | ", "Alert Mode:");
-  if (((conf & ALERT_MODE_MASK) >> 1) == 0) {
-    printf("%-12s |\n", "Comp");
-  } else if (((conf & ALERT_MODE_MASK) >> 1) == 1) {
-    printf("%-12s |\n", "Intr");
-  } else {
-    printf("%-12s |\n", "UNKNOWN");
+/**
+  @brief Converts seconds since boot to milliseconds, saturating at the end of
+   the millisecond clock.
+  @param seconds The number of seconds.
+  @return The number of milliseconds, or UINT32_MAX if it does not fit.
+*/
+static uint32_t seconds_to_ms(unsigned long seconds) {
+  return seconds <= UINT32_MAX / 1000 ? seconds * 1000 : UINT32_MAX;
+}
+
+/**
+  @brief Displays a menu for exporting the on-flash sample log and returns the
+   selected time range. The user can export everything, or enter a start and
+   end time in seconds since boot, either as CSV or in the compressed sample
+   format. If the user selects 'x', the function returns false without
+   modifying the range.
+  @param from_ms A pointer that receives the start of the range in
+   milliseconds.
+  @param to_ms A pointer that receives the end of the range in milliseconds.
+  @param is_compressed A pointer that receives whether the compressed format
+   was selected.
+  @return true if the user chose to export, false otherwise.
+*/
+bool show_log_menu(uint32_t *from_ms, uint32_t *to_ms, bool *is_compressed) {
+  char option;
+  while (1) {
+    clear_screen();
+    printf("Sample Log\n");
+    printf("[0] Export all samples\n");
+    printf("[1] Export a time range\n");
+    printf("[2] Export all samples compressed\n");
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    *is_compressed = option == '2';
+    if (option == '0' || option == '2') {
+      *from_ms = 0;
+      *to_ms = UINT32_MAX;
+      return true;
+    } else if (option == '1') {
+      char *input = menu_input;
+      clear_screen();
+      printf("From (s since boot): ");
+      get_input(input, MENU_INPUT_LEN);
+      *from_ms = seconds_to_ms(strtoul(input, NULL, 10));
+      printf("\nTo (s since boot): ");
+      get_input(input, MENU_INPUT_LEN);
+      *to_ms = seconds_to_ms(strtoul(input, NULL, 10));
+      printf("\n");
+      return true;
+    } else if (option == 'x') {
+      clear_screen();
+      return false;
+    }
   }
+}
 
-  printf("| %-18s | ", "Alert Polarity:");
-  if (((conf & ALERT_POLARITY_MASK) >> 2) == 0) {
-    printf("%-12s |\n", "Low");
-  } else if (((conf & ALERT_POLARITY_MASK) >> 2) == 1) {
-    printf("%-12s |\n", "High");
-  } else {
-    printf("%-12s |\n", "UNKNOWN");
+/**
+  @brief Displays a menu for querying the in-RAM history and returns the
+   selected tier. The user can print the raw samples, one rollup tier, or
+   every rollup tier at once.
+  @return HISTORY_RAW_TIER, 1 + the index of a rollup tier, HISTORY_TIERS + 1
+   for every rollup tier, or -1 if the user selects 'x'.
+*/
+int show_history_menu() {
+  char option;
+  while (1) {
+    clear_screen();
+    printf("History\n");
+    printf("[0] Raw samples\n");
+    printf("[1] 1 s rollups\n");
+    printf("[2] 1 min rollups\n");
+    printf("[3] 1 h rollups\n");
+    printf("[4] All rollups\n");
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option >= '0' && option <= '0' + HISTORY_TIERS + 1) {
+      return option - '0';
+    } else if (option == 'x') {
+      clear_screen();
+      return -1;
+    }
   }
+}
 
-  printf("| %-18s | ", "Fault Queue:");
-  if (((conf & FAULT_QUEUE_MASK) >> 3) == 0) {
-    printf("%-12d |\n", 1);
-  } else if (((conf & FAULT_QUEUE_MASK) >> 3) == 1) {
-    printf("%-12d |\n", 2);
-  } else if (((conf & FAULT_QUEUE_MASK) >> 3) == 2) {
-    printf("%-12d |\n", 4);
-  } else if (((conf & FAULT_QUEUE_MASK) >> 3) == 3) {
-    printf("%-12d |\n", 6);
-  } else {
-    printf("%-12s |\n", "UNKNOWN");
+/**
+  @brief Displays a menu for selecting the filter of a sensor. The user picks
+   a sensor, a filter type and, for every filter but none, its parameter.
+  @param sensor A pointer that receives the proj_sensors index.
+  @param type A pointer that receives one of FILTER_TYPES.
+  @param param A pointer that receives the shift or window length.
+  @return true if the user selected a filter, false if the user selects 'x'.
+*/
+bool show_filter_menu(uint8_t *sensor, uint8_t *type, uint8_t *param) {
+  char option;
+  char *input = menu_input;
+  while (1) {
+    clear_screen();
+    printf("Filters\n");
+    for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+      printf("[%d] Sensor %d\n", s, s);
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option < '0' + NUMBER_OF_SENSORS) {
+      *sensor = option - '0';
+      break;
+    }
   }
+  while (1) {
+    clear_screen();
+    printf("Sensor %u Filter\n", *sensor);
+    printf("[0] None\n");
+    printf("[1] Exponential moving average\n");
+    printf("[2] Moving average\n");
+    printf("[3] Median\n");
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
 
-  printf("| %-18s | ", "ADC Resolution:");
-  if (((conf & ADC_RESOLUTION_MASK) >> 5) == 0) {
-    printf("%-12s |\n", "0.5C");
-  } else if (((conf & ADC_RESOLUTION_MASK) >> 5) == 1) {
-    printf("%-12s |\n", "0.25C");
-  } else if (((conf & ADC_RESOLUTION_MASK) >> 5) == 2) {
-    printf("%-12s |\n", "0.125C");
-  } else if (((conf & ADC_RESOLUTION_MASK) >> 5) == 3) {
-    printf("%-12s |\n", "0.0625C");
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option <= '3') {
+      *type = option - '0';
+      break;
+    }
+  }
+  *param = 0;
+  if (*type == FILTER_EMA) {
+    printf("Smoothing shift (1-%d): ", FILTER_MAX_EMA_SHIFT);
+  } else if (*type == FILTER_BOXCAR) {
+    printf("Window (1-%d): ", FILTER_MAX_WINDOW);
+  } else if (*type == FILTER_MEDIAN) {
+    printf("Window (odd, 1-%d): ", FILTER_MAX_WINDOW);
   } else {
-    printf("%-12s |\n", "UNKNOWN");
+    return true;
   }
+  get_input(input, MENU_INPUT_LEN);
+  printf("\n");
+  // Out of range values become 0, which filter_configure rejects.
+  unsigned long value = strtoul(input, NULL, 10);
+  *param = value <= UINT8_MAX ? value : 0;
+  return true;
+}
 
-  printf("| %-18s | ", "One-Shot:");
-  if (((conf & ONE_SHOT_MASK) >> 7) == 0) {
-    printf("%-12s |\n", "Disable");
-  } else if (((conf & ONE_SHOT_MASK) >> 7) == 1) {
-    printf("%-12s |\n", "Enable");
-  } else {
-    printf("%-12s |\n", "UNKNOWN");
+/**
+  @brief Displays a menu for setting the oversampling of a sensor. The user
+   picks a sensor and the number of bits of resolution to gain.
+  @param sensor A pointer that receives the proj_sensors index.
+  @param extra_bits A pointer that receives the bits to gain, 0 for off.
+  @return true if the user made a selection, false if the user selects 'x'.
+*/
+bool show_oversample_menu(uint8_t *sensor, uint8_t *extra_bits) {
+  char option;
+  while (1) {
+    clear_screen();
+    printf("Oversampling\n");
+    for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+      printf("[%d] Sensor %d\n", s, s);
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option < '0' + NUMBER_OF_SENSORS) {
+      *sensor = option - '0';
+      break;
+    }
+  }
+  while (1) {
+    clear_screen();
+    printf("Sensor %u Oversampling\n", *sensor);
+    printf("[0] Off\n");
+    for (int bits = 1; bits <= OVERSAMPLE_MAX_EXTRA_BITS; bits++) {
+      printf("[%d] +%d bit (x%d conversions)\n", bits, bits, 1 << (2 * bits));
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option <= '0' + OVERSAMPLE_MAX_EXTRA_BITS) {
+      *extra_bits = option - '0';
+      return true;
+    }
+  }
+}
+
+/**
+  @brief Displays a menu for setting adaptive sampling. The user either
+   turns it off or enters the shortest and longest sampling periods.
+  @param min_ms A pointer that receives the shortest period, 0 for off.
+  @param max_ms A pointer that receives the longest period.
+  @return true if the user made a selection, false if the user selects 'x'.
+*/
+bool show_adaptive_menu(uint32_t *min_ms, uint32_t *max_ms) {
+  char option;
+  char *input = menu_input;
+  while (1) {
+    clear_screen();
+    printf("Adaptive Sampling Rate\n");
+    printf("[0] Off\n");
+    printf("[1] On\n");
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option == '0') {
+      *min_ms = 0;
+      *max_ms = 0;
+      return true;
+    } else if (option == '1') {
+      break;
+    }
+  }
+  clear_screen();
+  printf("Shortest period (ms): ");
+  get_input(input, MENU_INPUT_LEN);
+  *min_ms = strtoul(input, NULL, 10);
+  printf("\nLongest period (ms, up to %d): ", ADAPTIVE_MAX_INTERVAL_MS);
+  get_input(input, MENU_INPUT_LEN);
+  *max_ms = strtoul(input, NULL, 10);
+  printf("\n");
+  return true;
+}
+
+/**
+  @brief Prompts for a temperature and converts it to register units. The
+   temperature may be negative and have up to two decimal places, e.g.
+   "-5.25", and is rounded to the nearest 1/256 C.
+  @param prompt The prompt to display.
+  @param value A pointer that receives the temperature in 1/256 C.
+  @return true if the input is a valid temperature from -128 to 127.99 C,
+   false otherwise.
+*/
+static bool read_celsius(const char *prompt, int16_t *value) {
+  char *input = menu_input;
+  int32_t hundredths;
+  printf("%s", prompt);
+  get_input(input, MENU_INPUT_LEN);
+  printf("\n");
+  if (!str_to_hundredths(input, &hundredths) || hundredths < -12800 ||
+      hundredths > 12799) {
+    return false;
+  }
+  int32_t half = hundredths < 0 ? -50 : 50;
+  *value = (int16_t)((hundredths * 256 + half) / 100);
+  return true;
+}
+
+/**
+  @brief Displays a menu for setting the firmware alert thresholds of a
+   sensor. The user picks a sensor and enters the warning and critical
+   temperatures, the hysteresis and the debounce count.
+  @param sensor A pointer that receives the proj_sensors index.
+  @param thresholds A pointer that receives the thresholds.
+  @return true if the user entered valid thresholds, false otherwise.
+*/
+bool show_threshold_menu(uint8_t *sensor, AlertThresholds *thresholds) {
+  char option;
+  char *input = menu_input;
+  while (1) {
+    clear_screen();
+    printf("Sensor Alert Thresholds\n");
+    for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+      printf("[%d] Sensor %d\n", s, s);
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option < '0' + NUMBER_OF_SENSORS) {
+      *sensor = option - '0';
+      break;
+    }
+  }
+  clear_screen();
+  printf("Sensor %u Thresholds\n", *sensor);
+  if (!read_celsius("Warning (C): ", &thresholds->warning) ||
+      !read_celsius("Critical (C): ", &thresholds->critical) ||
+      !read_celsius("Hysteresis (C): ", &thresholds->hysteresis)) {
+    return false;
+  }
+  printf("Debounce (samples): ");
+  get_input(input, MENU_INPUT_LEN);
+  printf("\n");
+  // Out of range values become 0, which alert_set_thresholds rejects.
+  unsigned long debounce = strtoul(input, NULL, 10);
+  thresholds->debounce = debounce <= UINT8_MAX ? debounce : 0;
+  return true;
+}
+
+/**
+  @brief Displays a menu for setting the rate of change that raises a trend
+   event for a sensor. The user picks a sensor and enters the rate in C per
+   minute, where 0 disables the detector.
+  @param sensor A pointer that receives the proj_sensors index.
+  @param threshold A pointer that receives the rate in 1/256 C per minute.
+  @return true if the user entered a valid rate, false otherwise.
+*/
+bool show_trend_menu(uint8_t *sensor, int32_t *threshold) {
+  char option;
+  while (1) {
+    clear_screen();
+    printf("Sensor Trend Threshold\n");
+    for (int s = 0; s < NUMBER_OF_SENSORS; s++) {
+      printf("[%d] Sensor %d\n", s, s);
+    }
+    printf("[x] Return to main\n");
+    scanf(" %c", &option);
+
+    if (option == 'x') {
+      clear_screen();
+      return false;
+    } else if (option >= '0' && option < '0' + NUMBER_OF_SENSORS) {
+      *sensor = option - '0';
+      break;
+    }
   }
+  clear_screen();
+  int16_t rate;
+  if (!read_celsius("Rate (C/min, 0 to disable): ", &rate)) {
+    return false;
+  }
+  *threshold = rate;
+  return true;
+}
 
+/**
+  @brief Parses a 32-bit integer that encodes temperature sensor configuration
+  settings and prints them to the console. The function takes a 32-bit integer
+  as input that encodes temperature sensor configuration settings. It then
+  parses the integer and prints the settings in a formatted table to the
+  console. The table has one row per field of config_fields, i.e. Shutdown,
+  Alert Mode, Alert Polarity, Fault Queue, ADC Resolution, and One-Shot, each
+  showing the name of its current value.
+  @param conf A 32-bit integer that encodes the temperature sensor configuration
+  settings.
+*/
+void parse_config(uint8_t conf) {
+  printf("+--------------------+--------------+\n");
+  printf("|       Setting      |     Value    |\n");
+  printf("+--------------------+--------------+\n");
+  for (size_t i = 0; i < NUMBER_OF_CONFIG_FIELDS; i++) {
+    printf("| %s:%-*s | %-12s |\n", config_fields[i].label,
+           17 - (int)strlen(config_fields[i].label), "",
+           config_field_name(conf, i));
+  }
   printf("+--------------------+--------------+\n");
 }
@@ -1,5 +1,6 @@
 #ifndef __MENUE_HANDLER_H__
 #define __MENUE_HANDLER_H__
+#include "alert_engine.h"
 #include "pico/stdlib.h"
 
 enum ALERT_CONFIG_RESULT_TYPES {
@@ -10,12 +11,31 @@ enum ALERT_CONFIG_RESULT_TYPES {
   WRITE_TEMP_SET_LIMIT = 1 << 28,
   READ_TEMP_HYST_LIMIT = 1 << 27,
   READ_TEMP_SET_LIMIT = 1 << 26,
+  EDIT_SENSOR_THRESHOLDS = 1 << 25,
+  EDIT_TREND_THRESHOLD = 1 << 24,
+};
+
+enum PROFILE_MENU_RESULT_TYPES {
+  PROFILE_NO_CHANGE = 0,
+  PROFILE_SAVE = 1 << 31,
+  PROFILE_LOAD = 1 << 30,
+  PROFILE_SET_BOOT = 1 << 29,
+  PROFILE_CLEAR_BOOT = 1 << 28,
+  PROFILE_TUNE_BUSES = 1 << 27,
 };
 
 void show_landing_page();
 uint32_t show_config_menu();
 uint8_t show_dev_change_menu(uint8_t default_addr);
 uint32_t show_alert_menu(uint8_t *buf);
+uint32_t show_profile_menu(uint8_t *slot, char *name);
+bool show_log_menu(uint32_t *from_ms, uint32_t *to_ms, bool *is_compressed);
+int show_history_menu();
+bool show_filter_menu(uint8_t *sensor, uint8_t *type, uint8_t *param);
+bool show_oversample_menu(uint8_t *sensor, uint8_t *extra_bits);
+bool show_adaptive_menu(uint32_t *min_ms, uint32_t *max_ms);
+bool show_threshold_menu(uint8_t *sensor, AlertThresholds *thresholds);
+bool show_trend_menu(uint8_t *sensor, int32_t *threshold);
 void parse_config(uint8_t conf);
 
 #endif
@@ -0,0 +1,153 @@
+#include "oversample.h"
+
+#include <stdio.h>
+
+#include "sensor_driver.h"
+
+static Oversampler oversamplers[NUMBER_OF_SENSORS];
+
+/**
+ * @brief Returns the spacing of the conversion reads of a sensor.
+ *
+ * Reads are never closer than one conversion, since a faster read returns
+ * the same conversion again, and never closer than OVERSAMPLE_MIN_SPACING_MS,
+ * which caps the sustained bus rate of every oversampled sensor.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The spacing in milliseconds.
+ */
+static uint32_t read_spacing_ms(const SensorConfig *sensor) {
+  const SensorDriver *driver = sensor_driver_of(sensor);
+  uint32_t conversion_ms = driver->conversion_ms(driver->resolution(sensor));
+  return conversion_ms > OVERSAMPLE_MIN_SPACING_MS ? conversion_ms
+                                                   : OVERSAMPLE_MIN_SPACING_MS;
+}
+
+/**
+ * @brief Sets the resolution gained by oversampling a sensor.
+ *
+ * Every output decimates 4^extra_bits conversions, so each extra bit costs a
+ * factor of four in output rate. The gain relies on the one-LSB conversion
+ * noise of the sensor acting as dither.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param extra_bits 0 to turn oversampling off, or 1 to
+ * OVERSAMPLE_MAX_EXTRA_BITS.
+ *
+ * @return true if the setting was changed, false if it is out of range.
+ * Must be called on the sampling core; core1 goes through event_loop_call.
+ */
+bool oversample_configure(uint8_t sensor, uint8_t extra_bits) {
+  if (sensor >= NUMBER_OF_SENSORS || extra_bits > OVERSAMPLE_MAX_EXTRA_BITS) {
+    return false;
+  }
+  Oversampler *o = &oversamplers[sensor];
+  o->extra_bits = extra_bits;
+  o->count = 0;
+  o->sum = 0;
+  o->next_read = get_absolute_time();
+  o->effective_bits = 0;
+  return true;
+}
+
+/**
+ * @brief Reads every oversampled sensor whose next conversion is due and
+ * decimates each completed burst.
+ *
+ * Conversions are read through sensor_reg_read, one per sensor per call.
+ * The decimated value is the mean of the burst rounded to the nearest step
+ * of the native resolution plus extra_bits, capped at the 16 bits of the
+ * register.
+ * A failed read is skipped and retried one spacing later. It must be called
+ * from the sampling core only.
+ *
+ * @param sensors The sensors of the project.
+ * @param len The number of sensors.
+ *
+ * @return None.
+ */
+void oversample_service(const SensorConfig *sensors, size_t len) {
+  absolute_time_t now = get_absolute_time();
+  for (size_t i = 0; i < len && i < NUMBER_OF_SENSORS; i++) {
+    Oversampler *o = &oversamplers[i];
+    if (o->extra_bits == 0 || absolute_time_diff_us(o->next_read, now) < 0) {
+      continue;
+    }
+    o->next_read = delayed_by_ms(now, read_spacing_ms(&sensors[i]));
+
+    const SensorDriver *driver = sensor_driver_of(&sensors[i]);
+    uint16_t raw;
+    if (driver->read_raw(&sensors[i], &raw) != sizeof(raw)) {
+      continue;
+    }
+    o->sum += driver->convert(raw);
+    uint16_t burst = 1u << (2 * o->extra_bits);
+    if (++o->count < burst) {
+      continue;
+    }
+
+    uint8_t bits = driver->resolution(&sensors[i]) + o->extra_bits;
+    if (bits > 16) {
+      bits = 16;
+    }
+    int32_t mean = (o->sum + (o->sum >= 0 ? burst / 2 : -(burst / 2))) /
+                   (int32_t)burst;
+    int32_t lsb = 1 << (16 - bits);
+    int32_t value = (mean + lsb / 2) & ~(lsb - 1);
+    o->value = (int16_t)(value > INT16_MAX ? value - lsb : value);
+    o->effective_bits = bits;
+    o->timestamp = get_absolute_time();
+    o->count = 0;
+    o->sum = 0;
+  }
+}
+
+/**
+ * @brief Returns the time the next conversion read of any oversampled sensor
+ * is due.
+ *
+ * @return The earliest deadline, or at_the_end_of_time if no sensor is
+ * oversampled.
+ */
+absolute_time_t oversample_next_deadline() {
+  absolute_time_t deadline = at_the_end_of_time;
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if (oversamplers[i].extra_bits != 0 &&
+        absolute_time_diff_us(oversamplers[i].next_read, deadline) > 0) {
+      deadline = oversamplers[i].next_read;
+    }
+  }
+  return deadline;
+}
+
+/**
+ * @brief Returns the oversampling state of a sensor.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ *
+ * @return A pointer to the state, or NULL if the index is out of range.
+ */
+const Oversampler *oversample_output(uint8_t sensor) {
+  return sensor < NUMBER_OF_SENSORS ? &oversamplers[sensor] : NULL;
+}
+
+/**
+ * @brief Prints the oversampling setting and latest output of every sensor.
+ *
+ * @return None.
+ */
+void print_oversampling() {
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const Oversampler *o = &oversamplers[i];
+    if (o->extra_bits == 0) {
+      printf("Sensor %d oversampling: off\n", i);
+    } else if (o->effective_bits == 0) {
+      printf("Sensor %d oversampling: x%u, %u/%u conversions\n", i,
+             1u << (2 * o->extra_bits), o->count, 1u << (2 * o->extra_bits));
+    } else {
+      printf("Sensor %d oversampling: x%u, %.4f C (%u bits)\n", i,
+             1u << (2 * o->extra_bits), o->value / 256.0f, o->effective_bits);
+    }
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef __OVERSAMPLE_H__
+#define __OVERSAMPLE_H__
+
+#include "config.h"
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the state of one sensor's oversampling
+// extra_bits the resolution gained, 0 when oversampling is off; every output
+// decimates 4^extra_bits conversions
+// count the number of conversions accumulated in the current burst
+// sum the sum of the register values of the current burst
+// next_read the time of the next conversion read
+// value the latest decimated register value, truncated to its resolution
+// effective_bits the resolution of value, 0 until the first burst completes
+// timestamp the time the latest burst completed
+typedef struct {
+  uint8_t extra_bits;
+  uint16_t count;
+  int32_t sum;
+  absolute_time_t next_read;
+  int16_t value;
+  uint8_t effective_bits;
+  absolute_time_t timestamp;
+} Oversampler;
+
+bool oversample_configure(uint8_t sensor, uint8_t extra_bits);
+void oversample_service(const SensorConfig *sensors, size_t len);
+absolute_time_t oversample_next_deadline();
+const Oversampler *oversample_output(uint8_t sensor);
+void print_oversampling();
+
+#endif
@@ -0,0 +1,323 @@
+#include "pio_i2c.h"
+
+#include "config.h"
+#include "hardware/clocks.h"
+#include "i2c_util.h"
+#include "pio_i2c.pio.h"
+
+// Commands understood by the pio_i2c program, placed in bits 31:30.
+#define PIO_I2C_CMD_BYTE 0u
+#define PIO_I2C_CMD_START 1u
+#define PIO_I2C_CMD_STOP 2u
+#define PIO_I2C_CMD_RESTART 3u
+#define PIO_I2C_CYCLES_PER_BIT 32
+
+// Total time spent spinning on the PIO FIFOs, across all buses.
+static uint64_t wait_us_total = 0;
+
+/**
+ * @brief Encodes a byte transfer command for the pio_i2c program.
+ *
+ * @param data The byte to send, or 0xFF to release SDA while reading.
+ * @param drive_ack true to pull SDA low in the ACK slot (a read that expects
+ * more bytes), false to leave it to the slave.
+ *
+ * @return The TX FIFO word for the transfer.
+ */
+static uint32_t HOT_PATH_FUNC(encode_byte)(uint8_t data, bool drive_ack) {
+  return (PIO_I2C_CMD_BYTE << 30) | ((uint32_t)(uint8_t)~data << 22) |
+         ((uint32_t)drive_ack << 21);
+}
+
+/**
+ * @brief Queues a command word, giving up at the deadline.
+ *
+ * @param bus A pointer to the PIO I2C bus.
+ * @param word The TX FIFO word to queue.
+ * @param deadline The time by which the transaction must complete.
+ *
+ * @return true if the word was queued, false if the deadline passed.
+ */
+static bool HOT_PATH_FUNC(put_cmd)(PioI2C *bus, uint32_t word,
+                                   absolute_time_t deadline) {
+  absolute_time_t start = get_absolute_time();
+  while (pio_sm_is_tx_fifo_full(bus->pio, bus->sm)) {
+    if (time_reached(deadline)) {
+      return false;
+    }
+  }
+  wait_us_total += absolute_time_diff_us(start, get_absolute_time());
+  pio_sm_put(bus->pio, bus->sm, word);
+  return true;
+}
+
+/**
+ * @brief Transfers one byte and waits for the sampled bits.
+ *
+ * @param bus A pointer to the PIO I2C bus.
+ * @param data The byte to send, or 0xFF when reading.
+ * @param drive_ack true to ACK a byte being read.
+ * @param deadline The time by which the transaction must complete.
+ *
+ * @return The sampled data shifted left by one with the ACK bit (0 for ACK) in
+ * bit 0, or PICO_ERROR_TIMEOUT if the deadline passed.
+ */
+static int HOT_PATH_FUNC(xfer_byte)(PioI2C *bus, uint8_t data, bool drive_ack,
+                                    absolute_time_t deadline) {
+  if (!put_cmd(bus, encode_byte(data, drive_ack), deadline)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+  absolute_time_t start = get_absolute_time();
+  while (pio_sm_is_rx_fifo_empty(bus->pio, bus->sm)) {
+    if (time_reached(deadline)) {
+      return PICO_ERROR_TIMEOUT;
+    }
+  }
+  wait_us_total += absolute_time_diff_us(start, get_absolute_time());
+  return pio_sm_get(bus->pio, bus->sm) & 0x1FF;
+}
+
+/**
+ * @brief Runs a single register write transaction.
+ *
+ * @return nbytes + 1 on success, PICO_ERROR_GENERIC on a NAK, or
+ * PICO_ERROR_TIMEOUT if the deadline passed.
+ */
+static int HOT_PATH_FUNC(do_reg_write)(PioI2C *bus, uint8_t addr, uint8_t reg,
+                                       uint8_t *buf, uint8_t nbytes,
+                                       absolute_time_t deadline) {
+  if (!put_cmd(bus, PIO_I2C_CMD_START << 30, deadline)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+  int ret = xfer_byte(bus, addr << 1, false, deadline);
+  for (int i = -1; i < nbytes && ret >= 0 && !(ret & 1); i++) {
+    ret = xfer_byte(bus, i < 0 ? reg : buf[i], false, deadline);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  if (!put_cmd(bus, PIO_I2C_CMD_STOP << 30, deadline)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+  return (ret & 1) ? PICO_ERROR_GENERIC : nbytes + 1;
+}
+
+/**
+ * @brief Runs a single register read transaction.
+ *
+ * @return nbytes on success, PICO_ERROR_GENERIC on a NAK, or
+ * PICO_ERROR_TIMEOUT if the deadline passed.
+ */
+static int HOT_PATH_FUNC(do_reg_read)(PioI2C *bus, uint8_t addr, uint8_t reg,
+                                      uint8_t *buf, uint8_t nbytes,
+                                      absolute_time_t deadline) {
+  if (!put_cmd(bus, PIO_I2C_CMD_START << 30, deadline)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+  int ret = xfer_byte(bus, addr << 1, false, deadline);
+  if (ret >= 0 && !(ret & 1)) {
+    ret = xfer_byte(bus, reg, false, deadline);
+  }
+  if (ret >= 0 && !(ret & 1)) {
+    if (!put_cmd(bus, PIO_I2C_CMD_RESTART << 30, deadline)) {
+      return PICO_ERROR_TIMEOUT;
+    }
+    ret = xfer_byte(bus, (addr << 1) | 1, false, deadline);
+  }
+  bool is_nak = ret >= 0 && (ret & 1);
+  for (int i = 0; i < nbytes && ret >= 0 && !is_nak; i++) {
+    ret = xfer_byte(bus, 0xFF, i < nbytes - 1, deadline);
+    buf[i] = (uint8_t)(ret >> 1);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  if (!put_cmd(bus, PIO_I2C_CMD_STOP << 30, deadline)) {
+    return PICO_ERROR_TIMEOUT;
+  }
+  return is_nak ? PICO_ERROR_GENERIC : nbytes;
+}
+
+/**
+ * @brief Hands the SDA and SCL pins to the PIO with both lines released.
+ *
+ * @param bus A pointer to the PIO I2C bus.
+ *
+ * @return None.
+ */
+static void attach_pins(PioI2C *bus) {
+  uint32_t mask = (1u << bus->sda_pin_number) | (2u << bus->sda_pin_number);
+  pio_sm_set_pins_with_mask(bus->pio, bus->sm, 0, mask);
+  pio_sm_set_pindirs_with_mask(bus->pio, bus->sm, 0, mask);
+  pio_gpio_init(bus->pio, bus->sda_pin_number);
+  pio_gpio_init(bus->pio, bus->sda_pin_number + 1);
+}
+
+/**
+ * @brief Sets up a PIO state machine as an I2C master.
+ *
+ * This function loads the pio_i2c program into the PIO block, claims a free
+ * state machine, enables the pull-ups on SDA and SCL, and starts the state
+ * machine at the configured baud rate. The program dispatches commands with
+ * `out pc`, so it is pinned to offset 0 by its .origin and each PIO block can
+ * run one bus. Panics if that space is already taken, rather than starting a
+ * state machine on someone else's instructions.
+ *
+ * @param bus A pointer to the PIO I2C bus to initialize.
+ *
+ * @return None.
+ */
+void pio_i2c_init(PioI2C *bus) {
+  if (!pio_can_add_program(bus->pio, &pio_i2c_program)) {
+    panic("PIO I2C: offset 0 of PIO%u is in use", pio_get_index(bus->pio));
+  }
+  pio_add_program(bus->pio, &pio_i2c_program);
+  bus->sm = pio_claim_unused_sm(bus->pio, true);
+
+  uint sda = bus->sda_pin_number;
+  gpio_pull_up(sda);
+  gpio_pull_up(sda + 1);
+  attach_pins(bus);
+
+  pio_sm_config c = pio_i2c_program_get_default_config(0);
+  sm_config_set_out_pins(&c, sda, 1);
+  sm_config_set_set_pins(&c, sda, 1);
+  sm_config_set_in_pins(&c, sda);
+  sm_config_set_sideset_pins(&c, sda + 1);
+  sm_config_set_out_shift(&c, false, false, 32);
+  sm_config_set_in_shift(&c, false, false, 32);
+  pio_sm_init(bus->pio, bus->sm, pio_i2c_offset_entry, &c);
+  pio_i2c_set_baudrate(bus, bus->baudrate);
+  pio_sm_set_enabled(bus->pio, bus->sm, true);
+}
+
+/**
+ * @brief Sets the bus clock of a PIO I2C bus.
+ *
+ * @param bus A pointer to the PIO I2C bus.
+ * @param baudrate The requested bus clock in Hz, clamped to
+ * PIO_I2C_MAX_BAUDRATE.
+ *
+ * @return None.
+ */
+void pio_i2c_set_baudrate(PioI2C *bus, uint baudrate) {
+  if (baudrate > PIO_I2C_MAX_BAUDRATE) {
+    baudrate = PIO_I2C_MAX_BAUDRATE;
+  }
+  bus->baudrate = baudrate;
+  float div = (float)clock_get_hz(clk_sys) /
+              (float)(PIO_I2C_CYCLES_PER_BIT * baudrate);
+  pio_sm_set_clkdiv(bus->pio, bus->sm, div);
+}
+
+/**
+ * @brief Recovers a hung PIO I2C bus.
+ *
+ * This function stops the state machine, discards any queued commands, clears
+ * the bus with i2c_bus_clear, and restarts the program at its entry point.
+ *
+ * @param bus A pointer to the PIO I2C bus to recover.
+ *
+ * @return true if SDA is released after recovery, false otherwise.
+ */
+bool pio_i2c_recover(PioI2C *bus) {
+  pio_sm_set_enabled(bus->pio, bus->sm, false);
+  pio_sm_clear_fifos(bus->pio, bus->sm);
+  pio_sm_restart(bus->pio, bus->sm);
+
+  bool is_released =
+      i2c_bus_clear(bus->sda_pin_number, bus->sda_pin_number + 1);
+  attach_pins(bus);
+
+  pio_sm_exec(bus->pio, bus->sm, pio_encode_jmp(pio_i2c_offset_entry));
+  pio_sm_set_enabled(bus->pio, bus->sm, true);
+  bus->recoveries++;
+  return is_released;
+}
+
+/**
+ * @brief Writes data to a register over a PIO I2C bus.
+ *
+ * This function follows the same contract as reg_write: each attempt is
+ * bounded by twice I2C_XFER_TIMEOUT_MICRO_SEC, a timed out attempt triggers a
+ * bus recovery and is retried up to I2C_MAX_RETRIES times, and a NAK is
+ * returned as-is.
+ *
+ * @param bus A pointer to the PIO I2C bus to use for the write.
+ * @param addr The I2C address to write to.
+ * @param reg The register address to write to.
+ * @param buf A pointer to the buffer containing the data to write.
+ * @param nbytes The number of bytes to write to the register.
+ *
+ * @return The number of bytes written to the register, or a PICO_ERROR code.
+ */
+int HOT_PATH_FUNC(pio_i2c_reg_write)(PioI2C *bus, const uint8_t addr,
+                                     const uint8_t reg, uint8_t *buf,
+                                     const uint8_t nbytes) {
+  int ret = 0;
+  for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+    if (attempt > 0) {
+      pio_i2c_recover(bus);
+    }
+    ret = do_reg_write(bus, addr, reg, buf, nbytes,
+                       make_timeout_time_us(2 * I2C_XFER_TIMEOUT_MICRO_SEC));
+    if (ret >= 0) {
+      break;
+    }
+    if (ret != PICO_ERROR_TIMEOUT) {
+      bus->errors++;
+      break;
+    }
+    bus->timeouts++;
+  }
+  return ret;
+}
+
+/**
+ * @brief Reads data from a register over a PIO I2C bus.
+ *
+ * This function follows the same contract as reg_read, including the bound of
+ * I2C_WORST_CASE_STALL_MICRO_SEC on the total stall.
+ *
+ * @param bus A pointer to the PIO I2C bus to use for the read.
+ * @param addr The I2C address to read from.
+ * @param reg The register address to read from.
+ * @param buf A pointer to the buffer to store the read data.
+ * @param nbytes The number of bytes to read from the register.
+ *
+ * @return The number of bytes read from the register, or a PICO_ERROR code.
+ */
+int HOT_PATH_FUNC(pio_i2c_reg_read)(PioI2C *bus, const uint8_t addr,
+                                    const uint8_t reg, uint8_t *buf,
+                                    const uint8_t nbytes) {
+  int ret = 0;
+  if (nbytes < 1) {
+    return 0;
+  }
+  for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+    if (attempt > 0) {
+      pio_i2c_recover(bus);
+    }
+    ret = do_reg_read(bus, addr, reg, buf, nbytes,
+                      make_timeout_time_us(2 * I2C_XFER_TIMEOUT_MICRO_SEC));
+    if (ret >= 0) {
+      break;
+    }
+    if (ret != PICO_ERROR_TIMEOUT) {
+      bus->errors++;
+      break;
+    }
+    bus->timeouts++;
+  }
+  return ret;
+}
+
+/**
+ * @brief Returns the total time spent waiting on the PIO FIFOs since boot.
+ *
+ * The difference between a transaction's duration and the wait time it added
+ * is the CPU time the driver actually spent on the transaction.
+ *
+ * @return The accumulated wait time in microseconds.
+ */
+uint64_t pio_i2c_wait_us() { return wait_us_total; }
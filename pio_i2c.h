@@ -0,0 +1,34 @@
+#ifndef __PIO_I2C_H__
+#define __PIO_I2C_H__
+
+#include "hardware/pio.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the configuration and state of a PIO I2C bus
+// pio the PIO block running the bus
+// sm the state machine claimed by pio_i2c_init
+// sda_pin_number the SDA pin, SCL is always sda_pin_number + 1
+// baudrate the bus clock in Hz
+// timeouts the number of transfers that exceeded their deadline
+// errors the number of transfers that were NAKed
+// recoveries the number of bus recoveries
+typedef struct {
+  PIO pio;
+  uint sm;
+  uint sda_pin_number;
+  uint baudrate;
+  uint32_t timeouts;
+  uint32_t errors;
+  uint32_t recoveries;
+} PioI2C;
+
+void pio_i2c_init(PioI2C *bus);
+void pio_i2c_set_baudrate(PioI2C *bus, uint baudrate);
+bool pio_i2c_recover(PioI2C *bus);
+int pio_i2c_reg_write(PioI2C *bus, const uint8_t addr, const uint8_t reg,
+                      uint8_t *buf, const uint8_t nbytes);
+int pio_i2c_reg_read(PioI2C *bus, const uint8_t addr, const uint8_t reg,
+                     uint8_t *buf, const uint8_t nbytes);
+uint64_t pio_i2c_wait_us();
+
+#endif
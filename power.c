@@ -0,0 +1,106 @@
+#include "power.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "edge_capture.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+static volatile bool is_core1_waiting = false;
+static PowerStats power_stats = {0};
+
+/**
+ * @brief Waits on core0 until a deadline or an interrupt.
+ *
+ * The core sleeps in WFE until the timer deadline, a GPIO interrupt from a
+ * button or ALERT edge, or an event from core1. When built with LOW_POWER
+ * and core1 is also waiting, clk_sys is divided by POWER_IDLE_CLK_DIV for
+ * the duration of the wait and restored before returning, so tasks always
+ * run at full speed and the I2C and PIO dividers stay valid. The edge
+ * capture state machines keep sampling throughout, so their divider follows
+ * clk_sys to keep the tick rate constant. The system timer runs from
+ * clk_ref and USB from clk_usb, so neither is affected.
+ *
+ * @param wake The deadline of the next task.
+ *
+ * @return None.
+ */
+void power_idle_until(absolute_time_t wake) {
+  absolute_time_t start = get_absolute_time();
+#ifdef LOW_POWER
+  uint32_t div = clocks_hw->clk[clk_sys].div;
+  bool is_slow = is_core1_waiting;
+  if (is_slow) {
+    clocks_hw->clk[clk_sys].div = POWER_IDLE_CLK_DIV
+                                  << CLOCKS_CLK_SYS_DIV_INT_LSB;
+    edge_capture_clk_sys_divided(POWER_IDLE_CLK_DIV);
+  }
+#endif
+  best_effort_wfe_or_timeout(wake);
+#ifdef LOW_POWER
+  if (is_slow) {
+    clocks_hw->clk[clk_sys].div = div;
+    edge_capture_clk_sys_divided(1);
+  }
+#endif
+  absolute_time_t end = get_absolute_time();
+  uint64_t idle_us = absolute_time_diff_us(start, end);
+  power_stats.core0_idle_us += idle_us;
+#ifdef LOW_POWER
+  if (is_slow) {
+    power_stats.slow_us += idle_us;
+  }
+#endif
+
+  if (time_reached(wake)) {
+    uint32_t late_us = (uint32_t)absolute_time_diff_us(wake, end);
+    power_stats.timer_wakes++;
+    power_stats.last_wake_late_us = late_us;
+    if (late_us > power_stats.max_wake_late_us) {
+      power_stats.max_wake_late_us = late_us;
+    }
+  } else {
+    power_stats.event_wakes++;
+  }
+}
+
+/**
+ * @brief Waits on core1 until core0 sends an event.
+ *
+ * Core1 has no interrupts of its own, so it sleeps in WFE until core0 pushes
+ * a request through the FIFO or hands over a full sample log page, both of
+ * which signal an event. An event sent between the caller's last check and
+ * the WFE is latched, so none are lost.
+ *
+ * @return None.
+ */
+void power_core1_wait() {
+  absolute_time_t start = get_absolute_time();
+  is_core1_waiting = true;
+  __wfe();
+  is_core1_waiting = false;
+  power_stats.core1_idle_us +=
+      absolute_time_diff_us(start, get_absolute_time());
+}
+
+/**
+ * @brief Prints the awake time of both cores and the wake latency.
+ *
+ * @return None.
+ */
+void print_power_stats() {
+  uint64_t uptime_us = to_us_since_boot(get_absolute_time());
+  if (uptime_us == 0) {
+    return;
+  }
+  printf("Awake: core0 %.2f%%, core1 %.2f%%, slow clock %.2f%%\n",
+         100.0f - 100.0f * (float)power_stats.core0_idle_us / uptime_us,
+         100.0f - 100.0f * (float)power_stats.core1_idle_us / uptime_us,
+         100.0f * (float)power_stats.slow_us / uptime_us);
+  printf("Wakes: %lu timer, %lu event, late last %lu us, max %lu us\n",
+         (unsigned long)power_stats.timer_wakes,
+         (unsigned long)power_stats.event_wakes,
+         (unsigned long)power_stats.last_wake_late_us,
+         (unsigned long)power_stats.max_wake_late_us);
+}
@@ -0,0 +1,28 @@
+#ifndef __POWER_H__
+#define __POWER_H__
+
+#include "pico/stdlib.h"
+
+// Struct for storing power management statistics
+// core0_idle_us the total time core0 spent waiting
+// core1_idle_us the total time core1 spent waiting
+// slow_us the part of core0_idle_us spent with clk_sys divided down
+// timer_wakes the number of waits that ended at their deadline
+// event_wakes the number of waits ended early by an interrupt or event
+// last_wake_late_us how long after its deadline the last timer wake resumed
+// max_wake_late_us the longest delay between a deadline and the resume
+typedef struct {
+  uint64_t core0_idle_us;
+  uint64_t core1_idle_us;
+  uint64_t slow_us;
+  uint32_t timer_wakes;
+  uint32_t event_wakes;
+  uint32_t last_wake_late_us;
+  uint32_t max_wake_late_us;
+} PowerStats;
+
+void power_idle_until(absolute_time_t wake);
+void power_core1_wait();
+void print_power_stats();
+
+#endif
@@ -0,0 +1,236 @@
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "flash_util.h"
+#include "globals.h"
+#include "hardware/flash.h"
+#include "i2c_autotune.h"
+#include "reg_cache.h"
+
+_Static_assert(sizeof(ProfileStore) <= FLASH_SECTOR_SIZE,
+               "profile store must fit in one flash sector");
+
+// RAM image of the profile sector used to stage writes.
+static union {
+  ProfileStore store;
+  uint8_t bytes[PROFILE_STORE_BYTES];
+} staging;
+
+/**
+ * @brief Returns the profile store in flash if it is valid.
+ *
+ * The store is valid if its magic, version and CRC all match.
+ *
+ * @return A pointer to the memory-mapped store, or NULL if it is invalid.
+ */
+const ProfileStore *profile_store() {
+  const ProfileStore *store =
+      (const ProfileStore *)flash_contents(PROFILE_FLASH_OFFSET);
+  if (store->magic != PROFILE_MAGIC || store->version != PROFILE_VERSION) {
+    return NULL;
+  }
+  if (crc32((const uint8_t *)store, offsetof(ProfileStore, crc)) !=
+      store->crc) {
+    return NULL;
+  }
+  return store;
+}
+
+/**
+ * @brief Copies the valid store, or an empty one, into the staging buffer.
+ *
+ * @return None.
+ */
+static void stage_store() {
+  const ProfileStore *store = profile_store();
+  memset(&staging, 0xFF, sizeof(staging));
+  if (store != NULL) {
+    staging.store = *store;
+  } else {
+    memset(&staging.store, 0, sizeof(staging.store));
+    staging.store.magic = PROFILE_MAGIC;
+    staging.store.version = PROFILE_VERSION;
+    staging.store.active_profile = PROFILE_NONE;
+  }
+}
+
+/**
+ * @brief Seals the staging buffer with its CRC and writes it to flash.
+ *
+ * @return true if the store was written and reads back valid.
+ */
+static bool commit_store() {
+  staging.store.crc =
+      crc32((const uint8_t *)&staging.store, offsetof(ProfileStore, crc));
+  if (!flash_safe_write(PROFILE_FLASH_OFFSET, staging.bytes,
+                        sizeof(staging.bytes))) {
+    return false;
+  }
+  return profile_store() != NULL;
+}
+
+/**
+ * @brief Captures the current settings into a profile.
+ *
+ * The sensor registers come from the register shadow cache, the bus clocks
+ * from the hardware and PIO buses, and the sampling settings from the globals
+ * used by the sampling loop.
+ *
+ * @param profile A pointer to the profile to fill in.
+ * @param name The name of the profile, truncated to PROFILE_NAME_LEN - 1.
+ *
+ * @return true if the registers of every active sensor were captured, false
+ * if one could not be read, in which case the profile must not be saved.
+ */
+bool profile_capture(ConfigProfile *profile, const char *name) {
+  bool is_ok = true;
+
+  memset(profile, 0, sizeof(*profile));
+  strncpy(profile->name, name, PROFILE_NAME_LEN - 1);
+  profile->dev_addr = dev_addr;
+  profile->sample_interval_ms = sample_interval_ms;
+  profile->active_sensors = active_sensors;
+  profile->sample_at_boot = true;
+
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    profile->bus_baudrates[bus] = i2c_get_bus_baudrate(proj_i2c[bus].i2c_inst);
+  }
+  profile->bus_baudrates[NUMBER_OF_I2C] = proj_pio_i2c.baudrate;
+
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if (!(profile->active_sensors & (1u << i))) {
+      continue;
+    }
+    SensorProfile *regs = &profile->sensors[i];
+    is_ok &= reg_cache_read_config(&proj_sensors[i], &regs->config) &&
+             reg_cache_read_limit(&proj_sensors[i], TEMP_HYST_MIN_REG,
+                                  &regs->thyst) &&
+             reg_cache_read_limit(&proj_sensors[i], TEMP_SET_MAX_REG,
+                                  &regs->tset);
+  }
+  return is_ok;
+}
+
+/**
+ * @brief Applies a profile to the buses, sensors and sampling loop.
+ *
+ * Buses with a stored clock of 0 are auto-tuned. Sensor registers are written
+ * through the register shadow cache. Inactive sensors are left untouched.
+ *
+ * @param profile A pointer to the profile to apply.
+ *
+ * @return true if every active sensor was configured, false otherwise.
+ */
+bool profile_apply(const ConfigProfile *profile) {
+  bool is_ok = true;
+
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    if (profile->bus_baudrates[bus] == 0) {
+      autotune_bus(proj_i2c[bus].i2c_inst, NULL);
+    } else {
+      i2c_set_bus_baudrate(proj_i2c[bus].i2c_inst,
+                           profile->bus_baudrates[bus]);
+    }
+  }
+  if (profile->bus_baudrates[NUMBER_OF_I2C] == 0) {
+    autotune_bus(NULL, &proj_pio_i2c);
+  } else {
+    pio_i2c_set_baudrate(&proj_pio_i2c, profile->bus_baudrates[NUMBER_OF_I2C]);
+  }
+
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    if (!(profile->active_sensors & (1u << i))) {
+      continue;
+    }
+    const SensorProfile *regs = &profile->sensors[i];
+    is_ok &= reg_cache_write_config(&proj_sensors[i], regs->config) >= 0;
+    is_ok &= reg_cache_write_limit(&proj_sensors[i], TEMP_HYST_MIN_REG,
+                                   regs->thyst) >= 0;
+    is_ok &= reg_cache_write_limit(&proj_sensors[i], TEMP_SET_MAX_REG,
+                                   regs->tset) >= 0;
+  }
+
+  dev_addr = profile->dev_addr;
+  sample_interval_ms = profile->sample_interval_ms;
+  active_sensors = profile->active_sensors;
+  enable_read_temp = profile->sample_at_boot;
+  return is_ok;
+}
+
+/**
+ * @brief Saves a profile to a slot of the profile sector.
+ *
+ * @param slot The profile slot, less than NUMBER_OF_PROFILES.
+ * @param profile A pointer to the profile to save.
+ *
+ * @return true if the profile was written to flash.
+ */
+bool profile_save(uint8_t slot, const ConfigProfile *profile) {
+  if (slot >= NUMBER_OF_PROFILES) {
+    return false;
+  }
+  stage_store();
+  staging.store.profiles[slot] = *profile;
+  return commit_store();
+}
+
+/**
+ * @brief Selects the profile applied at boot.
+ *
+ * @param slot The profile slot, or PROFILE_NONE to boot with the sensors'
+ * power-on defaults.
+ *
+ * @return true if the selection was written to flash.
+ */
+bool profile_set_active(uint8_t slot) {
+  if (slot >= NUMBER_OF_PROFILES && slot != PROFILE_NONE) {
+    return false;
+  }
+  stage_store();
+  staging.store.active_profile = slot;
+  return commit_store();
+}
+
+/**
+ * @brief Applies the active profile, if any, during boot.
+ *
+ * This function must run on core0 before core1 is launched, since it does
+ * not park the other core.
+ *
+ * @return true if a profile was applied, false if the store is invalid or no
+ * profile is active.
+ */
+bool profile_apply_at_boot() {
+  const ProfileStore *store = profile_store();
+  if (store == NULL || store->active_profile >= NUMBER_OF_PROFILES) {
+    return false;
+  }
+  profile_apply(&store->profiles[store->active_profile]);
+  return true;
+}
+
+/**
+ * @brief Prints the profile slots stored in flash.
+ *
+ * @return None.
+ */
+void print_profiles() {
+  const ProfileStore *store = profile_store();
+  if (store == NULL) {
+    printf("No profiles stored\n");
+    return;
+  }
+  printf("+------+--------------+----------+---------+------+\n");
+  printf("| Slot | Name         | Interval | Sensors | Boot |\n");
+  printf("+------+--------------+----------+---------+------+\n");
+  for (int i = 0; i < NUMBER_OF_PROFILES; i++) {
+    const ConfigProfile *profile = &store->profiles[i];
+    printf("| %-4d | %-12.12s | %6lums | 0x%05lx | %-4s |\n", i, profile->name,
+           (unsigned long)profile->sample_interval_ms,
+           (unsigned long)profile->active_sensors,
+           store->active_profile == i ? "*" : "");
+  }
+  printf("+------+--------------+----------+---------+------+\n");
+}
@@ -0,0 +1,64 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the persisted registers of one sensor
+// config the config, laid out as TCN75A_CONFIG_FIELDS
+// thyst the ALERT release limit in 1/256 C, integer part in the high byte
+// tset the ALERT assert limit in 1/256 C, integer part in the high byte
+typedef struct {
+  uint8_t config;
+  uint16_t thyst;
+  uint16_t tset;
+} SensorProfile;
+
+// Struct for storing a named set of settings applied together
+// name the NUL-terminated profile name
+// dev_addr the address of the sensor the menus operate on
+// sample_interval_ms the period of the sampling loop
+// active_sensors bit i set if proj_sensors[i] is sampled
+// sample_at_boot whether sampling starts without pressing button 4
+// bus_baudrates the clock of each proj_i2c bus followed by the PIO bus, 0
+// to auto-tune the bus at boot
+// sensors the registers of each proj_sensors entry
+typedef struct {
+  char name[PROFILE_NAME_LEN];
+  uint8_t dev_addr;
+  uint32_t sample_interval_ms;
+  uint32_t active_sensors;
+  bool sample_at_boot;
+  uint32_t bus_baudrates[NUMBER_OF_I2C + 1];
+  SensorProfile sensors[NUMBER_OF_SENSORS];
+} ConfigProfile;
+
+// Struct for storing the profile sector
+// magic PROFILE_MAGIC when the sector holds a profile store
+// version PROFILE_VERSION of the layout that wrote the sector
+// active_profile the profile applied at boot, or PROFILE_NONE
+// profiles the profile slots
+// crc the CRC-32 of every preceding byte
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t active_profile;
+  uint8_t reserved;
+  ConfigProfile profiles[NUMBER_OF_PROFILES];
+  uint32_t crc;
+} ProfileStore;
+
+// Size of the profile store rounded up to whole flash pages.
+#define PROFILE_STORE_BYTES                                                    \
+  ((sizeof(ProfileStore) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE *            \
+   FLASH_PAGE_SIZE)
+
+const ProfileStore *profile_store();
+bool profile_capture(ConfigProfile *profile, const char *name);
+bool profile_apply(const ConfigProfile *profile);
+bool profile_save(uint8_t slot, const ConfigProfile *profile);
+bool profile_set_active(uint8_t slot);
+bool profile_apply_at_boot();
+void print_profiles();
+
+#endif
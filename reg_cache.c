@@ -0,0 +1,237 @@
+#include "reg_cache.h"
+
+#include "config.h"
+#include "sensor_driver.h"
+
+// Shadow copies of every sensor touched so far, allocated round-robin.
+static RegCacheEntry cache[REG_CACHE_ENTRIES] = {0};
+static size_t next_free = 0;
+// Whether writes are read back from the device and compared.
+static bool verify_on_write = REG_CACHE_VERIFY_ON_WRITE;
+
+/**
+ * @brief Returns the recovery count of the bus a sensor is attached to.
+ *
+ * A change in this value means the bus was reset and the sensor may have been
+ * power-cycled or left in an unknown state, so its shadow is reloaded.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The number of recoveries of the sensor's bus since boot.
+ */
+static uint32_t bus_epoch(const SensorConfig *sensor) {
+  if (sensor->i2c_inst != NULL) {
+    return i2c_recovery_count();
+  }
+  return sensor->pio_bus->recoveries;
+}
+
+/**
+ * @brief Finds the cache entry of a sensor, allocating one if needed.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return A pointer to the sensor's cache entry.
+ */
+static RegCacheEntry *find_entry(const SensorConfig *sensor) {
+  for (size_t i = 0; i < REG_CACHE_ENTRIES; i++) {
+    if (cache[i].sensor.i2c_inst == sensor->i2c_inst &&
+        cache[i].sensor.pio_bus == sensor->pio_bus &&
+        cache[i].sensor.addr == sensor->addr) {
+      return &cache[i];
+    }
+  }
+
+  RegCacheEntry *entry = &cache[next_free];
+  next_free = (next_free + 1) % REG_CACHE_ENTRIES;
+  entry->sensor = *sensor;
+  entry->is_valid = false;
+  return entry;
+}
+
+/**
+ * @brief Returns the cache entry of a sensor, reloading it if it is stale.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return A pointer to the sensor's cache entry. is_valid is false if the
+ * sensor could not be read.
+ */
+static RegCacheEntry *get_entry(const SensorConfig *sensor) {
+  RegCacheEntry *entry = find_entry(sensor);
+  if (!entry->is_valid || entry->epoch != bus_epoch(sensor)) {
+    reg_cache_load(sensor);
+  }
+  return entry;
+}
+
+/**
+ * @brief Reads the config and ALERT limits of a sensor into the cache
+ * through its driver.
+ *
+ * @param sensor A pointer to the sensor to load.
+ *
+ * @return true if the config and both limits were read, false otherwise.
+ */
+bool reg_cache_load(const SensorConfig *sensor) {
+  RegCacheEntry *entry = find_entry(sensor);
+  const SensorDriver *driver = sensor_driver_of(sensor);
+  uint8_t conf;
+  int16_t thyst;
+  int16_t tset;
+
+  entry->epoch = bus_epoch(sensor);
+  entry->is_valid = driver->read_config(sensor, &conf) &&
+                    driver->read_alert(sensor, &thyst, &tset);
+  if (entry->is_valid) {
+    entry->config = conf;
+    entry->thyst = (uint16_t)thyst;
+    entry->tset = (uint16_t)tset;
+  }
+  return entry->is_valid;
+}
+
+/**
+ * @brief Re-reads only the config of a sensor into the cache.
+ *
+ * @param sensor A pointer to the sensor to refresh.
+ *
+ * @return true if the config was read, false otherwise.
+ */
+bool reg_cache_refresh_config(const SensorConfig *sensor) {
+  RegCacheEntry *entry = get_entry(sensor);
+  uint8_t conf;
+
+  if (!entry->is_valid ||
+      !sensor_driver_of(sensor)->read_config(sensor, &conf)) {
+    entry->is_valid = false;
+    return false;
+  }
+  entry->config = conf;
+  return true;
+}
+
+/**
+ * @brief Loads the cache for every sensor in an array.
+ *
+ * @param sensors The array of sensors to load.
+ * @param len The number of sensors in the array.
+ *
+ * @return None.
+ */
+void reg_cache_load_all(const SensorConfig *sensors, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    reg_cache_load(&sensors[i]);
+  }
+}
+
+/**
+ * @brief Enables or disables read-back verification of cached writes.
+ *
+ * @param is_enabled true to re-read every written config from the device.
+ *
+ * @return None.
+ */
+void reg_cache_set_verify(bool is_enabled) { verify_on_write = is_enabled; }
+
+/**
+ * @brief Reads the config of a sensor from the cache.
+ *
+ * @param sensor A pointer to the sensor.
+ * @param conf A pointer that receives the cached config, laid out as
+ * TCN75A_CONFIG_FIELDS. It is left unchanged if the sensor could not be read.
+ *
+ * @return true if the cache holds the config, false if it could not be
+ * loaded.
+ */
+bool reg_cache_read_config(const SensorConfig *sensor, uint8_t *conf) {
+  RegCacheEntry *entry = get_entry(sensor);
+  if (entry->is_valid) {
+    *conf = entry->config;
+  }
+  return entry->is_valid;
+}
+
+/**
+ * @brief Writes the config of a sensor through its driver and the cache.
+ *
+ * Only the fields in the driver's config_mask are written; the others keep
+ * the value the sensor reported. The ONE-SHOT bit is excluded from
+ * verification, since the sensor clears it once the conversion it triggers
+ * has completed.
+ *
+ * @param sensor A pointer to the sensor.
+ * @param conf The config value, laid out as TCN75A_CONFIG_FIELDS.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if the write or its verification
+ * failed.
+ */
+int reg_cache_write_config(const SensorConfig *sensor, uint8_t conf) {
+  const SensorDriver *driver = sensor_driver_of(sensor);
+  RegCacheEntry *entry = get_entry(sensor);
+  int ret = driver->configure(sensor, conf);
+
+  if (ret < 0) {
+    entry->is_valid = false;
+    return ret;
+  }
+  entry->config =
+      (entry->config & ~driver->config_mask) | (conf & driver->config_mask);
+  if (verify_on_write) {
+    if (!reg_cache_refresh_config(sensor) ||
+        ((entry->config ^ conf) & driver->config_mask & ~ONE_SHOT_MASK) != 0) {
+      return PICO_ERROR_GENERIC;
+    }
+  }
+  return PICO_OK;
+}
+
+/**
+ * @brief Reads an ALERT limit of a sensor from the cache.
+ *
+ * @param sensor A pointer to the sensor.
+ * @param reg TEMP_HYST_MIN_REG or TEMP_SET_MAX_REG.
+ * @param value A pointer that receives the cached limit in 1/256 C. It is left
+ * unchanged if the sensor could not be read.
+ *
+ * @return true if the cache holds the limit, false if it could not be
+ * loaded.
+ */
+bool reg_cache_read_limit(const SensorConfig *sensor, uint8_t reg,
+                          uint16_t *value) {
+  RegCacheEntry *entry = get_entry(sensor);
+  if (entry->is_valid) {
+    *value = reg == TEMP_HYST_MIN_REG ? entry->thyst : entry->tset;
+  }
+  return entry->is_valid;
+}
+
+/**
+ * @brief Writes an ALERT limit of a sensor through its driver and the cache.
+ *
+ * The other limit is taken from the cache, and both are read back afterwards,
+ * since every part rounds limits to its own resolution.
+ *
+ * @param sensor A pointer to the sensor.
+ * @param reg TEMP_HYST_MIN_REG or TEMP_SET_MAX_REG.
+ * @param value The limit in 1/256 C, integer part in the high byte.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if the cache could not be loaded or
+ * the write or the read-back failed.
+ */
+int reg_cache_write_limit(const SensorConfig *sensor, uint8_t reg,
+                          uint16_t value) {
+  RegCacheEntry *entry = get_entry(sensor);
+  if (!entry->is_valid) {
+    return PICO_ERROR_GENERIC;
+  }
+  int16_t thyst = reg == TEMP_HYST_MIN_REG ? value : entry->thyst;
+  int16_t tset = reg == TEMP_HYST_MIN_REG ? entry->tset : value;
+  int ret = sensor_driver_of(sensor)->alert_config(sensor, thyst, tset);
+
+  if (ret < 0) {
+    entry->is_valid = false;
+    return ret;
+  }
+  return reg_cache_load(sensor) ? PICO_OK : PICO_ERROR_GENERIC;
+}
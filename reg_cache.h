@@ -0,0 +1,34 @@
+#ifndef __REG_CACHE_H__
+#define __REG_CACHE_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the shadow copy of a sensor's read-mostly registers
+// sensor the bus and address of the sensor
+// config the config, laid out as TCN75A_CONFIG_FIELDS
+// thyst the ALERT release limit in 1/256 C, integer part in the high byte
+// tset the ALERT assert limit in 1/256 C, integer part in the high byte
+// epoch the bus recovery count when the registers were loaded
+// is_valid whether the registers were loaded successfully
+typedef struct {
+  SensorConfig sensor;
+  uint8_t config;
+  uint16_t thyst;
+  uint16_t tset;
+  uint32_t epoch;
+  bool is_valid;
+} RegCacheEntry;
+
+bool reg_cache_load(const SensorConfig *sensor);
+bool reg_cache_refresh_config(const SensorConfig *sensor);
+void reg_cache_load_all(const SensorConfig *sensors, size_t len);
+void reg_cache_set_verify(bool is_enabled);
+bool reg_cache_read_config(const SensorConfig *sensor, uint8_t *conf);
+int reg_cache_write_config(const SensorConfig *sensor, uint8_t conf);
+bool reg_cache_read_limit(const SensorConfig *sensor, uint8_t reg,
+                          uint16_t *value);
+int reg_cache_write_limit(const SensorConfig *sensor, uint8_t reg,
+                          uint16_t value);
+
+#endif
@@ -0,0 +1,245 @@
+#include "sample_codec.h"
+
+// Tags of the encoded stream. Every sample after the key frame is predicted
+// to arrive one previous interval after the last one with the same value.
+//   0xxxxxxx  one sample on time, value delta zig-zag encoded in x
+//   10xxxxxx  x + 1 samples on time with an unchanged value
+//   11000000  one sample, zig-zag varint interval change and value delta
+//   11000001  key frame, varint timestamp and zig-zag varint value
+#define TAG_SHORT_MASK 0x80
+#define TAG_RUN 0x80
+#define TAG_RUN_MAX 64
+#define TAG_FULL 0xC0
+#define TAG_KEY 0xC1
+
+/**
+ * @brief Maps a signed value to an unsigned one with small magnitudes first.
+ *
+ * @param value The signed value.
+ *
+ * @return 0, -1, 1, -2, 2... mapped to 0, 1, 2, 3, 4...
+ */
+static uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Inverts zigzag.
+ *
+ * @param value The zig-zag encoded value.
+ *
+ * @return The signed value.
+ */
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Writes an unsigned LEB128 varint.
+ *
+ * @param value The value to write.
+ * @param out The buffer to write to, with room for 5 bytes.
+ *
+ * @return The number of bytes written.
+ */
+static size_t put_varint(uint32_t value, uint8_t *out) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ *
+ * @param in The buffer to read from.
+ * @param len The number of bytes available.
+ * @param value A pointer that receives the value.
+ *
+ * @return The number of bytes read, or 0 if the varint is truncated.
+ */
+static size_t get_varint(const uint8_t *in, size_t len, uint32_t *value) {
+  uint32_t result = 0;
+  for (size_t n = 0; n < len && n < 5; n++) {
+    result |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+    if (!(in[n] & 0x80)) {
+      *value = result;
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Resets an encoder so its next sample is a key frame.
+ *
+ * @param enc A pointer to the encoder.
+ *
+ * @return None.
+ */
+void sample_encoder_init(SampleEncoder *enc) {
+  enc->prev_ts = 0;
+  enc->prev_delta_ts = 0;
+  enc->prev_raw = 0;
+  enc->run = 0;
+  enc->has_key = false;
+}
+
+/**
+ * @brief Emits any pending run of repeated samples.
+ *
+ * @param enc A pointer to the encoder.
+ * @param out The buffer to write to, with room for 1 byte.
+ *
+ * @return The number of bytes written.
+ */
+size_t sample_encoder_flush(SampleEncoder *enc, uint8_t *out) {
+  if (enc->run == 0) {
+    return 0;
+  }
+  out[0] = TAG_RUN | (enc->run - 1);
+  enc->run = 0;
+  return 1;
+}
+
+/**
+ * @brief Encodes one sample of a sensor's stream.
+ *
+ * Samples that arrive on the predicted interval with an unchanged value are
+ * accumulated into runs of up to 64 and cost a single byte per run. Samples
+ * on time with a small value change cost one byte. Anything else is encoded
+ * as a zig-zag varint delta-of-delta timestamp and value delta.
+ *
+ * @param enc A pointer to the encoder.
+ * @param ts The sample timestamp, in any monotonic unit.
+ * @param raw The sample value.
+ * @param out The buffer to write to, with room for SAMPLE_CODEC_MAX_BYTES.
+ *
+ * @return The number of bytes written, which is 0 while a run is pending.
+ */
+size_t sample_encode(SampleEncoder *enc, uint32_t ts, uint16_t raw,
+                     uint8_t *out) {
+  size_t n = 0;
+
+  if (!enc->has_key) {
+    out[n++] = TAG_KEY;
+    n += put_varint(ts, &out[n]);
+    n += put_varint(zigzag((int16_t)raw), &out[n]);
+    enc->has_key = true;
+    enc->prev_ts = ts;
+    enc->prev_raw = raw;
+    return n;
+  }
+
+  int32_t delta_ts = (int32_t)(ts - enc->prev_ts);
+  int32_t dod = delta_ts - enc->prev_delta_ts;
+  uint32_t zz_value = zigzag((int16_t)(raw - enc->prev_raw));
+
+  enc->prev_ts = ts;
+  enc->prev_delta_ts = delta_ts;
+  enc->prev_raw = raw;
+
+  if (dod == 0 && zz_value == 0) {
+    if (++enc->run == TAG_RUN_MAX) {
+      n += sample_encoder_flush(enc, &out[n]);
+    }
+    return n;
+  }
+
+  n += sample_encoder_flush(enc, &out[n]);
+  if (dod == 0 && zz_value < TAG_SHORT_MASK) {
+    out[n++] = (uint8_t)zz_value;
+  } else {
+    out[n++] = TAG_FULL;
+    n += put_varint(zigzag(dod), &out[n]);
+    n += put_varint(zz_value, &out[n]);
+  }
+  return n;
+}
+
+/**
+ * @brief Resets a decoder to the start of a stream.
+ *
+ * @param dec A pointer to the decoder.
+ *
+ * @return None.
+ */
+void sample_decoder_init(SampleDecoder *dec) {
+  dec->prev_ts = 0;
+  dec->prev_delta_ts = 0;
+  dec->prev_raw = 0;
+}
+
+/**
+ * @brief Emits a sample predicted from the decoder state.
+ *
+ * @param dec A pointer to the decoder.
+ * @param dod The change of interval relative to the previous one.
+ * @param value_delta The change of value relative to the previous sample.
+ * @param sink The function that receives the sample.
+ * @param ctx The context passed to the sink.
+ *
+ * @return None.
+ */
+static void emit_sample(SampleDecoder *dec, int32_t dod, int32_t value_delta,
+                        sample_sink_t sink, void *ctx) {
+  dec->prev_delta_ts += dod;
+  dec->prev_ts += dec->prev_delta_ts;
+  dec->prev_raw += value_delta;
+  sink(dec->prev_ts, dec->prev_raw, ctx);
+}
+
+/**
+ * @brief Decodes a buffer of a sensor's stream.
+ *
+ * The buffer must end on a record boundary, which is always the case for the
+ * output of sample_encode and sample_encoder_flush.
+ *
+ * @param dec A pointer to the decoder.
+ * @param in The encoded bytes.
+ * @param len The number of encoded bytes.
+ * @param sink The function that receives each decoded sample.
+ * @param ctx The context passed to the sink.
+ *
+ * @return The number of bytes consumed, less than len if the buffer is
+ * truncated or malformed.
+ */
+size_t sample_decode(SampleDecoder *dec, const uint8_t *in, size_t len,
+                     sample_sink_t sink, void *ctx) {
+  size_t i = 0;
+  while (i < len) {
+    uint8_t tag = in[i];
+    if (!(tag & TAG_SHORT_MASK)) {
+      emit_sample(dec, 0, unzigzag(tag), sink, ctx);
+      i++;
+    } else if ((tag & 0xC0) == TAG_RUN) {
+      for (int r = 0; r <= (tag & 0x3F); r++) {
+        emit_sample(dec, 0, 0, sink, ctx);
+      }
+      i++;
+    } else if (tag == TAG_FULL || tag == TAG_KEY) {
+      uint32_t a;
+      uint32_t b;
+      size_t na = get_varint(&in[i + 1], len - i - 1, &a);
+      size_t nb = na ? get_varint(&in[i + 1 + na], len - i - 1 - na, &b) : 0;
+      if (nb == 0) {
+        break;
+      }
+      if (tag == TAG_KEY) {
+        dec->prev_ts = a;
+        dec->prev_delta_ts = 0;
+        dec->prev_raw = (uint16_t)unzigzag(b);
+        sink(dec->prev_ts, dec->prev_raw, ctx);
+      } else {
+        emit_sample(dec, unzigzag(a), unzigzag(b), sink, ctx);
+      }
+      i += 1 + na + nb;
+    } else {
+      break;
+    }
+  }
+  return i;
+}
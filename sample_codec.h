@@ -0,0 +1,48 @@
+#ifndef __SAMPLE_CODEC_H__
+#define __SAMPLE_CODEC_H__
+
+// The codec only depends on the C standard library so the host-side decoder
+// in tools/ can be built from the same source.
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Worst-case bytes produced by one call to sample_encode: a pending run, a
+// tag, and two 5-byte varints.
+#define SAMPLE_CODEC_MAX_BYTES 12
+
+// Struct for storing the state of one sensor's sample stream encoder
+// prev_ts the timestamp of the previous sample
+// prev_delta_ts the interval between the previous two samples
+// prev_raw the previous register value
+// run the number of repeated samples not yet emitted
+// has_key whether a key frame has been emitted
+typedef struct {
+  uint32_t prev_ts;
+  int32_t prev_delta_ts;
+  uint16_t prev_raw;
+  uint8_t run;
+  bool has_key;
+} SampleEncoder;
+
+// Struct for storing the state of one sensor's sample stream decoder
+// prev_ts the timestamp of the previous sample
+// prev_delta_ts the interval between the previous two samples
+// prev_raw the previous register value
+typedef struct {
+  uint32_t prev_ts;
+  int32_t prev_delta_ts;
+  uint16_t prev_raw;
+} SampleDecoder;
+
+typedef void (*sample_sink_t)(uint32_t ts, uint16_t raw, void *ctx);
+
+void sample_encoder_init(SampleEncoder *enc);
+size_t sample_encode(SampleEncoder *enc, uint32_t ts, uint16_t raw,
+                     uint8_t *out);
+size_t sample_encoder_flush(SampleEncoder *enc, uint8_t *out);
+void sample_decoder_init(SampleDecoder *dec);
+size_t sample_decode(SampleDecoder *dec, const uint8_t *in, size_t len,
+                     sample_sink_t sink, void *ctx);
+
+#endif
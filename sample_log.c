@@ -0,0 +1,401 @@
+#include "sample_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "console.h"
+#include "flash_util.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "sample_codec.h"
+
+#define LOG_PAGES (LOG_FLASH_SECTORS * FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define LOG_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
+_Static_assert(sizeof(LogPage) <= FLASH_PAGE_SIZE,
+               "log page must fit in one flash page");
+
+// Ping-pong page buffers. core0 fills one while core1 programs the other.
+static union {
+  LogPage page;
+  uint8_t bytes[FLASH_PAGE_SIZE];
+} buffers[2];
+static volatile bool is_buffer_full[2] = {false, false};
+static uint fill_index = 0;
+
+// Write position in the log, owned by core1 after sample_log_init.
+static uint32_t head_page = 0;
+static uint32_t next_seq = 0;
+static uint16_t boot_count = 0;
+static bool is_head_sector_erased = false;
+
+static LogStats log_stats = {0};
+
+/**
+ * @brief Returns the page at an index of the log region.
+ *
+ * @param index The page index, less than LOG_PAGES.
+ *
+ * @return A pointer to the memory-mapped page.
+ */
+static const LogPage *log_page(uint32_t index) {
+  return (const LogPage *)flash_contents(LOG_FLASH_OFFSET +
+                                         index * FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief Computes the CRC of a page, excluding its magic and CRC fields.
+ *
+ * @param page A pointer to the page.
+ *
+ * @return The CRC-32 to store in the page header.
+ */
+static uint32_t page_crc(const LogPage *page) {
+  uint32_t crc = crc32((const uint8_t *)&page->seq,
+                       offsetof(LogPage, crc) - offsetof(LogPage, seq));
+  return crc ^ crc32((const uint8_t *)page->records,
+                     page->count * sizeof(LogRecord));
+}
+
+/**
+ * @brief Checks that a page was programmed completely.
+ *
+ * @param page A pointer to the page.
+ *
+ * @return true if the page holds valid records.
+ */
+static bool is_page_valid(const LogPage *page) {
+  return page->magic == LOG_PAGE_MAGIC &&
+         page->count <= LOG_RECORDS_PER_PAGE && page_crc(page) == page->crc;
+}
+
+/**
+ * @brief Resets a RAM page buffer to an empty page.
+ *
+ * @param index The buffer index.
+ *
+ * @return None.
+ */
+static void reset_buffer(uint index) {
+  memset(buffers[index].bytes, 0xFF, FLASH_PAGE_SIZE);
+  buffers[index].page.count = 0;
+}
+
+/**
+ * @brief Checks that a page is still erased.
+ *
+ * @param page A pointer to the page.
+ *
+ * @return true if every byte of the page reads 0xFF.
+ */
+static bool is_page_erased(const LogPage *page) {
+  const uint8_t *bytes = (const uint8_t *)page;
+  for (size_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+    if (bytes[i] != 0xFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the page with the highest sequence number below a limit.
+ *
+ * Only page headers are read.
+ *
+ * @param limit Pages with a sequence number at or above this are ignored.
+ * @param is_limited false to ignore limit.
+ * @param index A pointer that receives the page index.
+ *
+ * @return true if a page was found.
+ */
+static bool find_newest_page(uint32_t limit, bool is_limited,
+                             uint32_t *index) {
+  bool is_found = false;
+  uint32_t max_seq = 0;
+  for (uint32_t i = 0; i < LOG_PAGES; i++) {
+    const LogPage *page = log_page(i);
+    if (page->magic == LOG_PAGE_MAGIC && (!is_limited || page->seq < limit) &&
+        (!is_found || page->seq > max_seq)) {
+      is_found = true;
+      max_seq = page->seq;
+      *index = i;
+    }
+  }
+  return is_found;
+}
+
+/**
+ * @brief Finds the write position of the log.
+ *
+ * This function places the head after the newest page that passes its CRC.
+ * The headers are scanned for the highest sequence number, and only that
+ * page is checked; a page torn by a power failure fails the check and the
+ * scan moves on to the next newest, so normally one CRC is computed. If the
+ * page at the head is not blank, e.g. because it is the torn page, the head
+ * moves to the start of the next sector, which is erased before use. It
+ * must be called on core0 before core1 is launched.
+ *
+ * @return None.
+ */
+void sample_log_init() {
+  uint32_t newest = 0;
+  bool is_limited = false;
+  uint32_t limit = 0;
+
+  while (find_newest_page(limit, is_limited, &newest)) {
+    const LogPage *page = log_page(newest);
+    if (is_page_valid(page)) {
+      head_page = (newest + 1) % LOG_PAGES;
+      next_seq = page->seq + 1;
+      boot_count = page->boot + 1;
+      break;
+    }
+    limit = page->seq;
+    is_limited = true;
+  }
+
+  is_head_sector_erased = head_page % LOG_PAGES_PER_SECTOR != 0;
+  if (is_head_sector_erased && !is_page_erased(log_page(head_page))) {
+    head_page = (head_page / LOG_PAGES_PER_SECTOR + 1) *
+                LOG_PAGES_PER_SECTOR % LOG_PAGES;
+    is_head_sector_erased = false;
+  }
+  reset_buffer(0);
+  reset_buffer(1);
+}
+
+/**
+ * @brief Appends a sample to the log from the sampling path.
+ *
+ * This function only copies the record into a RAM page buffer, so its cost is
+ * constant. When the buffer is full it is handed to sample_log_service on
+ * core1. If core1 has not yet written the other buffer, the record is dropped
+ * and counted instead of waiting.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param timestamp_ms The sample time in milliseconds since boot.
+ * @param raw The ambient temperature register.
+ *
+ * @return true if the record was buffered, false if it was dropped.
+ */
+bool sample_log_append(uint8_t sensor, uint32_t timestamp_ms, uint16_t raw) {
+  if (is_buffer_full[fill_index]) {
+    log_stats.dropped++;
+    return false;
+  }
+
+  LogPage *page = &buffers[fill_index].page;
+  LogRecord *record = &page->records[page->count++];
+  record->timestamp_ms = timestamp_ms;
+  record->sensor = sensor;
+  record->flags = 0xFF;
+  record->raw = raw;
+  log_stats.appended++;
+
+  if (page->count == LOG_RECORDS_PER_PAGE) {
+    __dmb();
+    is_buffer_full[fill_index] = true;
+    fill_index ^= 1;
+    // Wake core1 if it is waiting for work.
+    __sev();
+  }
+  return true;
+}
+
+/**
+ * @brief Performs at most one pending flash operation of the log.
+ *
+ * This function is called from the core1 idle loop. If a full page buffer is
+ * waiting, it either erases the sector the head is entering or programs the
+ * page, never both, so each call parks core0 for a single flash operation.
+ * core0 services the park between two tasks, so no transfer is interrupted.
+ * A sector erase keeps core0 parked with interrupts disabled for the whole
+ * erase, typically 45 ms and at most 400 ms for the flash on the Pico; the
+ * samples, button presses and ALERT edges of that time are serviced once it
+ * is released, and the PIO edge capture keeps their timestamps exact.
+ * Sectors are erased one at a time as the head wraps around the region,
+ * which spreads wear evenly over every sector.
+ *
+ * @return true if a flash operation is still pending, false if core1 may
+ * wait for the next page.
+ */
+bool sample_log_service() {
+  uint index = fill_index ^ 1;
+  if (!is_buffer_full[index]) {
+    return false;
+  }
+  __dmb();
+
+  uint32_t offset = LOG_FLASH_OFFSET + head_page * FLASH_PAGE_SIZE;
+  if (!is_head_sector_erased) {
+    flash_safe_erase(offset, FLASH_SECTOR_SIZE);
+    is_head_sector_erased = true;
+    log_stats.sectors_erased++;
+    return true;
+  }
+
+  LogPage *page = &buffers[index].page;
+  page->magic = LOG_PAGE_MAGIC;
+  page->seq = next_seq++;
+  page->boot = boot_count;
+  page->crc = page_crc(page);
+  flash_safe_program(offset, buffers[index].bytes, FLASH_PAGE_SIZE);
+  log_stats.pages_written++;
+
+  head_page = (head_page + 1) % LOG_PAGES;
+  if (head_page % LOG_PAGES_PER_SECTOR == 0) {
+    is_head_sector_erased = false;
+  }
+  reset_buffer(index);
+  __dmb();
+  is_buffer_full[index] = false;
+  return is_buffer_full[index ^ 1];
+}
+
+/**
+ * @brief Streams the logged samples in a time range to the console.
+ *
+ * This function walks the log from the oldest page to the newest, reading
+ * each page directly from flash and printing its matching records as CSV, so
+ * no more than one record is held in RAM at a time. Pages that fail their CRC
+ * are skipped. Records in the RAM buffers that have not been written yet are
+ * not included. The log holds the samples of several boots and timestamps
+ * restart at every boot, so a range matches the same times of every boot;
+ * the boot column tells them apart.
+ *
+ * @param from_ms The start of the range in milliseconds since boot.
+ * @param to_ms The end of the range in milliseconds since boot, inclusive.
+ *
+ * @return None.
+ */
+void sample_log_export(uint32_t from_ms, uint32_t to_ms) {
+  printf("boot,sensor,timestamp_ms,temp_c\n");
+  for (uint32_t n = 0; n < LOG_PAGES; n++) {
+    const LogPage *page = log_page((head_page + n) % LOG_PAGES);
+    if (!is_page_valid(page)) {
+      continue;
+    }
+    for (uint16_t i = 0; i < page->count; i++) {
+      const LogRecord *record = &page->records[i];
+      if (record->timestamp_ms < from_ms || record->timestamp_ms > to_ms) {
+        continue;
+      }
+      console_wait_space(CONSOLE_LINE_BYTES);
+      printf("%u,%u,%lu,%.4f\n", page->boot, record->sensor,
+             (unsigned long)record->timestamp_ms,
+             (int16_t)record->raw / 256.0f);
+    }
+  }
+  printf("Done.\n");
+}
+
+/**
+ * @brief Prints the encoded bytes of a sensor stream as one hex line.
+ *
+ * @param sensor The proj_sensors index of the stream.
+ * @param line The encoded bytes.
+ * @param len The number of encoded bytes; nothing is printed if it is 0.
+ *
+ * @return None.
+ */
+static void print_encoded_line(uint sensor, const uint8_t *line, size_t len) {
+  if (len == 0) {
+    return;
+  }
+  console_wait_space(CONSOLE_LINE_BYTES);
+  printf("%u:", sensor);
+  for (size_t i = 0; i < len; i++) {
+    printf("%02x", line[i]);
+  }
+  printf("\n");
+}
+
+/**
+ * @brief Streams the logged samples in a time range to the console in the
+ * compressed sample format.
+ *
+ * Each sensor's samples are encoded as a separate stream with sample_encode
+ * and printed as hex lines of the form "<sensor>:<bytes>" as soon as
+ * LOG_EXPORT_LINE_BYTES have accumulated, so only one line per sensor is
+ * held in RAM. A "#boot <n>" line starts the samples of each boot, and every
+ * stream restarts with a key frame after it. The output is decoded on the
+ * host with tools/sample_decode.c.
+ *
+ * @param from_ms The start of the range in milliseconds since boot.
+ * @param to_ms The end of the range in milliseconds since boot, inclusive.
+ *
+ * @return None.
+ */
+void sample_log_export_compressed(uint32_t from_ms, uint32_t to_ms) {
+  SampleEncoder encoders[NUMBER_OF_SENSORS];
+  uint8_t lines[NUMBER_OF_SENSORS]
+               [LOG_EXPORT_LINE_BYTES + SAMPLE_CODEC_MAX_BYTES];
+  size_t line_len[NUMBER_OF_SENSORS] = {0};
+  uint32_t samples = 0;
+  uint32_t bytes = 0;
+  int boot = -1;
+
+  printf("#samples v1\n");
+  for (uint32_t n = 0; n < LOG_PAGES; n++) {
+    const LogPage *page = log_page((head_page + n) % LOG_PAGES);
+    if (!is_page_valid(page)) {
+      continue;
+    }
+    for (uint16_t i = 0; i < page->count; i++) {
+      const LogRecord *record = &page->records[i];
+      if (record->timestamp_ms < from_ms || record->timestamp_ms > to_ms ||
+          record->sensor >= NUMBER_OF_SENSORS) {
+        continue;
+      }
+      if (page->boot != boot) {
+        for (uint s = 0; s < NUMBER_OF_SENSORS; s++) {
+          if (boot >= 0) {
+            line_len[s] +=
+                sample_encoder_flush(&encoders[s], &lines[s][line_len[s]]);
+          }
+          print_encoded_line(s, lines[s], line_len[s]);
+          bytes += line_len[s];
+          line_len[s] = 0;
+          sample_encoder_init(&encoders[s]);
+        }
+        boot = page->boot;
+        printf("#boot %d\n", boot);
+      }
+
+      uint s = record->sensor;
+      line_len[s] += sample_encode(&encoders[s], record->timestamp_ms,
+                                   record->raw, &lines[s][line_len[s]]);
+      samples++;
+      if (line_len[s] >= LOG_EXPORT_LINE_BYTES) {
+        print_encoded_line(s, lines[s], line_len[s]);
+        bytes += line_len[s];
+        line_len[s] = 0;
+      }
+    }
+  }
+  for (uint s = 0; s < NUMBER_OF_SENSORS && boot >= 0; s++) {
+    line_len[s] += sample_encoder_flush(&encoders[s], &lines[s][line_len[s]]);
+    print_encoded_line(s, lines[s], line_len[s]);
+    bytes += line_len[s];
+  }
+  // The ratio is against the register values alone, not the LogRecord
+  // padding and timestamps around them.
+  uint32_t raw_bytes = samples * sizeof(((LogRecord *)0)->raw);
+  printf("#%lu samples in %lu bytes, %.2fx vs %lu register bytes\n",
+         (unsigned long)samples, (unsigned long)bytes,
+         bytes ? (float)raw_bytes / bytes : 0.0f, (unsigned long)raw_bytes);
+  printf("Done.\n");
+}
+
+/**
+ * @brief Prints the log statistics to the console.
+ *
+ * @return None.
+ */
+void print_sample_log_stats() {
+  printf("Log: %lu appended, %lu dropped, %lu pages written, %lu erases\n",
+         (unsigned long)log_stats.appended, (unsigned long)log_stats.dropped,
+         (unsigned long)log_stats.pages_written,
+         (unsigned long)log_stats.sectors_erased);
+}
@@ -0,0 +1,55 @@
+#ifndef __SAMPLE_LOG_H__
+#define __SAMPLE_LOG_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+
+// Struct for storing one logged sample
+// timestamp_ms the sample time in milliseconds since boot
+// sensor the proj_sensors index of the sensor
+// flags reserved, 0xFF in flash
+// raw the ambient temperature register, integer part in the high byte
+typedef struct {
+  uint32_t timestamp_ms;
+  uint8_t sensor;
+  uint8_t flags;
+  uint16_t raw;
+} LogRecord;
+
+// Struct for storing one flash page of the log
+// magic LOG_PAGE_MAGIC once the page has been programmed
+// seq the sequence number of the page, increasing across the whole log
+// boot the boot count when the page was written
+// count the number of valid records
+// crc the CRC-32 of seq, boot, count and the records; a page torn by a power
+// failure fails this check and is skipped
+// records the samples
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint16_t boot;
+  uint16_t count;
+  uint32_t crc;
+  LogRecord records[LOG_RECORDS_PER_PAGE];
+} LogPage;
+
+// Struct for storing log statistics
+// appended the number of records accepted from the sampling path
+// dropped the number of records dropped because both RAM pages were full
+// pages_written the number of pages programmed since boot
+// sectors_erased the number of sectors erased since boot
+typedef struct {
+  uint32_t appended;
+  uint32_t dropped;
+  uint32_t pages_written;
+  uint32_t sectors_erased;
+} LogStats;
+
+void sample_log_init();
+bool sample_log_append(uint8_t sensor, uint32_t timestamp_ms, uint16_t raw);
+bool sample_log_service();
+void sample_log_export(uint32_t from_ms, uint32_t to_ms);
+void sample_log_export_compressed(uint32_t from_ms, uint32_t to_ms);
+void print_sample_log_stats();
+
+#endif
@@ -0,0 +1,160 @@
+#include "sensor_driver.h"
+
+#include "config.h"
+#include "reg_cache.h"
+
+// Drivers tried by sensor_driver_probe, most specific check first.
+static const SensorDriver *const drivers[] = {&mcp9808_driver, &tmp102_driver,
+                                              &tcn75a_driver, &lm75_driver};
+
+/**
+ * @brief Returns the driver of a sensor.
+ *
+ * A sensor that names no driver, such as the one the menus build from the
+ * current bus and address, takes the driver detected for the proj_sensors
+ * entry at the same location.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The driver named in the sensor's config or detected at its
+ * location, or the TCN75A driver if there is none.
+ */
+const SensorDriver *HOT_PATH_FUNC(sensor_driver_of)(
+    const SensorConfig *sensor) {
+  if (sensor->driver != NULL) {
+    return sensor->driver;
+  }
+  for (size_t i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const SensorConfig *known = &proj_sensors[i];
+    if (known->driver != NULL && known->i2c_inst == sensor->i2c_inst &&
+        known->pio_bus == sensor->pio_bus && known->addr == sensor->addr) {
+      return known->driver;
+    }
+  }
+  return &tcn75a_driver;
+}
+
+/**
+ * @brief Identifies the part at a sensor's address.
+ *
+ * Every driver whose address range covers the address is asked in turn
+ * whether it recognises the device. The checks only read registers, but they
+ * move the register pointer, so this must not run while the sensor is being
+ * sampled.
+ *
+ * @param sensor A pointer to the bus and address to probe.
+ *
+ * @return The matching driver, or NULL if no driver recognises the device.
+ */
+const SensorDriver *sensor_driver_probe(const SensorConfig *sensor) {
+  for (size_t i = 0; i < count_of(drivers); i++) {
+    if (sensor->addr >= drivers[i]->first_addr &&
+        sensor->addr <= drivers[i]->last_addr && drivers[i]->probe(sensor)) {
+      return drivers[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Sets the driver of every sensor to the part found at its address.
+ *
+ * Sensors that do not answer, or that no driver recognises, keep the driver
+ * they have. The register cache of every identified sensor is loaded, so the
+ * resolution the fast path looks up is known before the first sample. Like
+ * sensor_driver_probe, this must not run while the sensors are being
+ * sampled.
+ *
+ * @param sensors The array of sensors to identify.
+ * @param len The number of sensors in the array.
+ *
+ * @return None.
+ */
+void sensor_driver_detect(SensorConfig *sensors, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    const SensorDriver *driver = sensor_driver_probe(&sensors[i]);
+    if (driver != NULL) {
+      sensors[i].driver = driver;
+      reg_cache_load(&sensors[i]);
+    }
+  }
+}
+
+/**
+ * @brief Reads a 16-bit register, high byte first.
+ *
+ * @param sensor A pointer to the sensor to read from.
+ * @param reg The register address to read from.
+ * @param value A pointer that receives the register value.
+ *
+ * @return The number of bytes read, or a PICO_ERROR code.
+ */
+int sensor_driver_read_word(const SensorConfig *sensor, uint8_t reg,
+                            uint16_t *value) {
+  uint8_t buf[2];
+  int ret = sensor_reg_read(sensor, reg, buf, sizeof(buf));
+  if (ret == sizeof(buf)) {
+    *value = ((uint16_t)buf[0] << 8) | buf[1];
+  }
+  return ret;
+}
+
+/**
+ * @brief Writes a 16-bit register, high byte first.
+ *
+ * @param sensor A pointer to the sensor to write to.
+ * @param reg The register address to write to.
+ * @param value The value to write.
+ *
+ * @return The number of bytes written, or a PICO_ERROR code.
+ */
+int sensor_driver_write_word(const SensorConfig *sensor, uint8_t reg,
+                             uint16_t value) {
+  uint8_t buf[2] = {value >> 8, value & 0xFF};
+  return sensor_reg_write(sensor, reg, buf, sizeof(buf));
+}
+
+/**
+ * @brief Writes the hysteresis and set limits of a part with the LM75
+ * register map, at TEMP_HYST_MIN_REG and TEMP_SET_MAX_REG.
+ *
+ * @param sensor A pointer to the sensor to write to.
+ * @param hyst The temperature below which ALERT releases, in 1/256 C.
+ * @param set The temperature above which ALERT asserts, in 1/256 C.
+ * @param mask The bits the part implements in its limit registers.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a write failed.
+ */
+int sensor_driver_write_limits(const SensorConfig *sensor, int16_t hyst,
+                               int16_t set, uint16_t mask) {
+  int ret = sensor_driver_write_word(sensor, TEMP_HYST_MIN_REG,
+                                     (uint16_t)hyst & mask);
+  if (ret >= 0) {
+    ret = sensor_driver_write_word(sensor, TEMP_SET_MAX_REG,
+                                   (uint16_t)set & mask);
+  }
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the hysteresis and set limits of a part with the LM75
+ * register map, whose limit registers already hold 1/256 C.
+ *
+ * @param sensor A pointer to the sensor to read from.
+ * @param hyst A pointer that receives the hysteresis limit.
+ * @param set A pointer that receives the set limit.
+ *
+ * @return true if both registers were read, false otherwise.
+ */
+bool sensor_driver_read_limits(const SensorConfig *sensor, int16_t *hyst,
+                               int16_t *set) {
+  uint16_t thyst;
+  uint16_t tset;
+  if (sensor_driver_read_word(sensor, TEMP_HYST_MIN_REG, &thyst) != 2 ||
+      sensor_driver_read_word(sensor, TEMP_SET_MAX_REG, &tset) != 2) {
+    return false;
+  }
+  *hyst = (int16_t)thyst;
+  *set = (int16_t)tset;
+  return true;
+}
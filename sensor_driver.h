@@ -0,0 +1,64 @@
+#ifndef __SENSOR_DRIVER_H__
+#define __SENSOR_DRIVER_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the operations of one temperature sensor part
+// name the part name printed by the bus scan
+// first_addr the lowest I2C address the part can be strapped to
+// last_addr the highest I2C address the part can be strapped to
+// max_baudrate the fastest bus clock in Hz the part is rated for
+// temp_reg the register holding the temperature, read by the fast path
+// config_mask the TCN75A_CONFIG_FIELDS bits the part can be configured with
+// probe returns whether the device at the sensor's address is this part,
+// reading registers only
+// resolution returns the resolution in bits the part converts at
+// conversion_ms returns the typical time of one conversion at a resolution
+// configure writes a config value laid out as TCN75A_CONFIG_FIELDS to the
+// part's own registers, dropping the fields the part does not have
+// read_config reads the part's config back in the TCN75A_CONFIG_FIELDS layout
+// read_raw reads the temperature register, returning the bytes read
+// convert converts a temperature register value to 1/256 C
+// alert_config sets the ALERT output to assert above set and to release
+// below hyst, both in 1/256 C
+// read_alert reads the limits set by alert_config back in 1/256 C, as the
+// part rounded them
+struct SensorDriver {
+  const char *name;
+  uint8_t first_addr;
+  uint8_t last_addr;
+  uint max_baudrate;
+  uint8_t temp_reg;
+  uint8_t config_mask;
+  bool (*probe)(const SensorConfig *sensor);
+  uint8_t (*resolution)(const SensorConfig *sensor);
+  uint32_t (*conversion_ms)(uint8_t bits);
+  int (*configure)(const SensorConfig *sensor, uint8_t conf);
+  bool (*read_config)(const SensorConfig *sensor, uint8_t *conf);
+  int (*read_raw)(const SensorConfig *sensor, uint16_t *raw);
+  int16_t (*convert)(uint16_t raw);
+  int (*alert_config)(const SensorConfig *sensor, int16_t hyst, int16_t set);
+  bool (*read_alert)(const SensorConfig *sensor, int16_t *hyst, int16_t *set);
+};
+
+// Drivers in the order the bus scan probes them. The parts with an ID
+// register come first, so the looser checks only see what is left.
+extern const SensorDriver mcp9808_driver;
+extern const SensorDriver tmp102_driver;
+extern const SensorDriver tcn75a_driver;
+extern const SensorDriver lm75_driver;
+
+const SensorDriver *sensor_driver_of(const SensorConfig *sensor);
+const SensorDriver *sensor_driver_probe(const SensorConfig *sensor);
+void sensor_driver_detect(SensorConfig *sensors, size_t len);
+int sensor_driver_read_word(const SensorConfig *sensor, uint8_t reg,
+                            uint16_t *value);
+int sensor_driver_write_word(const SensorConfig *sensor, uint8_t reg,
+                             uint16_t value);
+int sensor_driver_write_limits(const SensorConfig *sensor, int16_t hyst,
+                               int16_t set, uint16_t mask);
+bool sensor_driver_read_limits(const SensorConfig *sensor, int16_t *hyst,
+                               int16_t *set);
+
+#endif
@@ -0,0 +1,292 @@
+#include "sensor_poll.h"
+
+#include <stdio.h>
+
+#include "config.h"
+#include "filter.h"
+#include "oversample.h"
+#include "sensor_driver.h"
+#include "util.h"
+
+// Number of bytes in the temperature register of every supported part.
+#define SAMPLE_NBYTES 2
+
+// A sample read always fits in the I2C FIFO, so reg_read_start cannot reject
+// it.
+_Static_assert(SAMPLE_NBYTES > 0 && SAMPLE_NBYTES < I2C_FIFO_DEPTH,
+               "a sample read must fit in the I2C FIFO");
+
+// Per-bus utilization counters, indexed like proj_i2c.
+static BusStats bus_stats[NUMBER_OF_I2C] = {0};
+// Utilization counters of the PIO I2C buses.
+static BusStats pio_stats = {0};
+// Number of samples completed since boot, across all buses.
+static uint32_t total_samples = 0;
+
+/**
+ * @brief Looks up the proj_i2c index of an I2C instance.
+ *
+ * @param i2c_inst A pointer to the I2C instance to look up.
+ *
+ * @return The index into proj_i2c, or -1 if the instance is not configured.
+ */
+static int HOT_PATH_FUNC(find_bus_index)(i2c_inst_t *i2c_inst) {
+  for (int i = 0; i < NUMBER_OF_I2C; i++) {
+    if (proj_i2c[i].i2c_inst == i2c_inst) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Finds the next sensor on a bus, starting at a given position.
+ *
+ * @param sensors The array of sensors being polled.
+ * @param len The number of sensors in the array.
+ * @param active_mask Bit i set if sensors[i] is to be polled.
+ * @param bus The proj_i2c index of the bus.
+ * @param start The sensor index to start searching from.
+ *
+ * @return The index of the next sensor on the bus, or len if there is none.
+ */
+static size_t HOT_PATH_FUNC(next_sensor_on_bus)(const SensorConfig *sensors,
+                                                size_t len,
+                                                uint32_t active_mask, int bus,
+                                                size_t start) {
+  for (size_t i = start; i < len; i++) {
+    if ((active_mask & (1u << i)) &&
+        sensors[i].i2c_inst == proj_i2c[bus].i2c_inst) {
+      return i;
+    }
+  }
+  return len;
+}
+
+/**
+ * @brief Stores the result of a read in a sample.
+ *
+ * @param sample A pointer to the sample to update.
+ * @param driver The driver of the sensor that was read.
+ * @param ret The value returned by the read.
+ * @param buf The bytes read from the temperature register.
+ * @param now The time the read completed.
+ *
+ * @return None.
+ */
+static void HOT_PATH_FUNC(store_sample)(SensorSample *sample,
+                                        const SensorDriver *driver, int ret,
+                                        const uint8_t *buf,
+                                        absolute_time_t now) {
+  sample->status = ret;
+  sample->timestamp = now;
+  if (ret == SAMPLE_NBYTES) {
+    sample->raw = driver->convert(((uint16_t)buf[0] << 8) | buf[1]);
+    total_samples++;
+  }
+}
+
+/**
+ * @brief Reads the temperature of a sensor on a PIO I2C bus.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param sample A pointer to the sample that receives the reading.
+ *
+ * @return None.
+ */
+static void HOT_PATH_FUNC(poll_pio_sensor)(const SensorConfig *sensor,
+                                           SensorSample *sample) {
+  const SensorDriver *driver = sensor_driver_of(sensor);
+  uint8_t buf[SAMPLE_NBYTES];
+  absolute_time_t start = get_absolute_time();
+  int ret = pio_i2c_reg_read(sensor->pio_bus, sensor->addr, driver->temp_reg,
+                             buf, SAMPLE_NBYTES);
+  absolute_time_t now = get_absolute_time();
+
+  store_sample(sample, driver, ret, buf, now);
+  pio_stats.busy_us += absolute_time_diff_us(start, now);
+  pio_stats.transactions++;
+  if (ret != SAMPLE_NBYTES) {
+    pio_stats.failures++;
+  }
+}
+
+/**
+ * @brief Reads the temperature of every sensor, overlapping the transfers on
+ * different I2C instances.
+ *
+ * Each bus works through its own sensors one at a time, but all buses have a
+ * transfer in flight concurrently, so the time to poll the whole set is set by
+ * the busiest bus rather than by the total number of sensors. A transfer that
+ * aborts or exceeds I2C_XFER_TIMEOUT_MICRO_SEC is retried through reg_read,
+ * which recovers the bus if needed. Sensors on PIO I2C buses are read while
+ * the first hardware transfers are in flight. Every read goes to the
+ * temperature register of the sensor's driver and is converted to 1/256 C, so
+ * sensors of different parts are polled alike.
+ *
+ * @param sensors The array of sensors to poll.
+ * @param len The number of sensors in the array.
+ * @param active_mask Bit i set if sensors[i] is to be polled. The samples of
+ * other sensors are left untouched.
+ * @param samples The array that receives one sample per sensor.
+ *
+ * @return None.
+ */
+void HOT_PATH_FUNC(poll_sensors)(const SensorConfig *sensors, size_t len,
+                                 uint32_t active_mask, SensorSample *samples) {
+  size_t cursor[NUMBER_OF_I2C];
+  absolute_time_t started[NUMBER_OF_I2C];
+  size_t pending = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    if (!(active_mask & (1u << i))) {
+      continue;
+    }
+    if (find_bus_index(sensors[i].i2c_inst) >= 0) {
+      pending++;
+    } else if (sensors[i].pio_bus == NULL) {
+      samples[i].status = PICO_ERROR_GENERIC;
+    }
+  }
+
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    cursor[bus] = next_sensor_on_bus(sensors, len, active_mask, bus, 0);
+    if (cursor[bus] < len) {
+      reg_read_start(sensors[cursor[bus]].i2c_inst, sensors[cursor[bus]].addr,
+                     sensor_driver_of(&sensors[cursor[bus]])->temp_reg,
+                     SAMPLE_NBYTES);
+      started[bus] = get_absolute_time();
+    }
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    if ((active_mask & (1u << i)) && sensors[i].i2c_inst == NULL &&
+        sensors[i].pio_bus != NULL) {
+      poll_pio_sensor(&sensors[i], &samples[i]);
+    }
+  }
+
+  while (pending > 0) {
+    for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+      size_t idx = cursor[bus];
+      if (idx >= len) {
+        continue;
+      }
+      const SensorDriver *driver = sensor_driver_of(&sensors[idx]);
+
+      uint8_t buf[SAMPLE_NBYTES];
+      int ret = reg_read_poll(sensors[idx].i2c_inst, buf, SAMPLE_NBYTES);
+      absolute_time_t now = get_absolute_time();
+      int64_t elapsed_us = absolute_time_diff_us(started[bus], now);
+
+      if (ret == 0 && elapsed_us < I2C_XFER_TIMEOUT_MICRO_SEC) {
+        continue;
+      }
+      if (ret <= 0) {
+        bus_stats[bus].failures++;
+        if (ret == 0) {
+          i2c_bus_recover(sensors[idx].i2c_inst);
+        }
+        ret = reg_read(sensors[idx].i2c_inst, sensors[idx].addr,
+                       driver->temp_reg, buf, SAMPLE_NBYTES);
+        now = get_absolute_time();
+        elapsed_us = absolute_time_diff_us(started[bus], now);
+      }
+
+      store_sample(&samples[idx], driver, ret, buf, now);
+      bus_stats[bus].busy_us += elapsed_us;
+      bus_stats[bus].transactions++;
+      pending--;
+
+      cursor[bus] = next_sensor_on_bus(sensors, len, active_mask, bus,
+                                       idx + 1);
+      if (cursor[bus] < len) {
+        reg_read_start(sensors[cursor[bus]].i2c_inst,
+                       sensors[cursor[bus]].addr,
+                       sensor_driver_of(&sensors[cursor[bus]])->temp_reg,
+                       SAMPLE_NBYTES);
+        started[bus] = get_absolute_time();
+      }
+    }
+  }
+}
+
+/**
+ * @brief Prints the most recent sample of every sensor to the console.
+ *
+ * @param sensors The array of sensors that were polled.
+ * @param samples The array of samples returned by poll_sensors.
+ * @param len The number of sensors in the arrays.
+ *
+ * @return None.
+ */
+void print_sensor_samples(const SensorConfig *sensors,
+                          const SensorSample *samples, size_t len) {
+  clear_screen();
+  for (size_t i = 0; i < len; i++) {
+    if (sensors[i].i2c_inst == NULL) {
+      printf("Sensor %u (%s, pio @ 0x%02x)\n", (unsigned)i,
+             sensor_driver_of(&sensors[i])->name, sensors[i].addr);
+    } else {
+      printf("Sensor %u (%s, i2c%d @ 0x%02x)\n", (unsigned)i,
+             sensor_driver_of(&sensors[i])->name,
+             find_bus_index(sensors[i].i2c_inst), sensors[i].addr);
+    }
+    if (samples[i].status == SAMPLE_NBYTES) {
+      print_temp_table(samples[i].raw >> 8, samples[i].raw & 0xFF);
+      if (filter_type(i) != FILTER_NONE) {
+        printf("Filtered: %.4f C\n", samples[i].filtered / 256.0f);
+      }
+      const Oversampler *o = oversample_output(i);
+      if (o->extra_bits != 0 && o->effective_bits != 0) {
+        printf("Oversampled: %.4f C (%u bits)\n", o->value / 256.0f,
+               o->effective_bits);
+      }
+    } else if (samples[i].status == 0) {
+      printf("Not sampled\n");
+    } else {
+      printf("[WARNING] Read failed (%d)\n", samples[i].status);
+    }
+  }
+}
+
+/**
+ * @brief Returns the mean time of one sensor read across all buses.
+ *
+ * @return The mean transfer time in microseconds, or 0 before the first read.
+ */
+uint32_t sensor_poll_mean_read_us() {
+  uint64_t busy_us = pio_stats.busy_us;
+  uint32_t transactions = pio_stats.transactions;
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    busy_us += bus_stats[bus].busy_us;
+    transactions += bus_stats[bus].transactions;
+  }
+  return transactions ? (uint32_t)(busy_us / transactions) : 0;
+}
+
+/**
+ * @brief Prints the per-bus utilization and aggregate sample rate since boot.
+ *
+ * @return None.
+ */
+void print_bus_utilization() {
+  uint64_t uptime_us = to_us_since_boot(get_absolute_time());
+  if (uptime_us == 0) {
+    return;
+  }
+  for (int bus = 0; bus < NUMBER_OF_I2C; bus++) {
+    printf("i2c%d @ %u Hz: %lu transfers, %lu failed, %.2f%% busy\n", bus,
+           i2c_get_bus_baudrate(proj_i2c[bus].i2c_inst),
+           (unsigned long)bus_stats[bus].transactions,
+           (unsigned long)bus_stats[bus].failures,
+           100.0f * (float)bus_stats[bus].busy_us / (float)uptime_us);
+  }
+  printf("pio @ %u Hz: %lu transfers, %lu failed, %.2f%% busy\n",
+         proj_pio_i2c.baudrate,
+         (unsigned long)pio_stats.transactions,
+         (unsigned long)pio_stats.failures,
+         100.0f * (float)pio_stats.busy_us / (float)uptime_us);
+  printf("Aggregate: %.1f samples/s\n",
+         (float)total_samples * 1000000.0f / (float)uptime_us);
+}
@@ -0,0 +1,36 @@
+#ifndef __SENSOR_POLL_H__
+#define __SENSOR_POLL_H__
+
+#include "i2c_util.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the most recent reading of a sensor
+// raw the temperature in 1/256 C, integer part in the high byte
+// timestamp the time the reading completed
+// filtered the register value after the sensor's filter stage
+// status the number of bytes read, or a PICO_ERROR code
+typedef struct {
+  uint16_t raw;
+  int16_t filtered;
+  absolute_time_t timestamp;
+  int status;
+} SensorSample;
+
+// Struct for storing the utilization counters of one I2C instance
+// busy_us the total time a transfer was in flight on the bus
+// transactions the number of completed transfers
+// failures the number of transfers that aborted or timed out
+typedef struct {
+  uint64_t busy_us;
+  uint32_t transactions;
+  uint32_t failures;
+} BusStats;
+
+void poll_sensors(const SensorConfig *sensors, size_t len,
+                  uint32_t active_mask, SensorSample *samples);
+void print_sensor_samples(const SensorConfig *sensors,
+                          const SensorSample *samples, size_t len);
+uint32_t sensor_poll_mean_read_us();
+void print_bus_utilization();
+
+#endif
@@ -0,0 +1,435 @@
+#include "tcn75a.h"
+
+#include "config.h"
+#include "reg_cache.h"
+#include "sensor_driver.h"
+#include "util.h"
+
+// Temperature register bits below the power-on 9-bit resolution, which a
+// TCN75A leaves clear and an 11-bit LM75 may set.
+#define TCN75A_PROBE_TEMP_MASK 0x007F
+
+// Every register must fit the shared message buffers of reg_write.
+#define TCN75A_CHECK_REG_BYTES(name, address, bytes)                           \
+  _Static_assert((bytes) <= I2C_MAX_REG_BYTES,                                 \
+                 #name " is larger than I2C_MAX_REG_BYTES");
+TCN75A_REGISTERS(TCN75A_CHECK_REG_BYTES)
+
+// The names of the values of every config register field, e.g.
+// ADC_RESOLUTION_VALUES, with one name per value the field can take.
+#define TCN75A_FIELD_VALUES(name, label, flag, shift, width, ...)              \
+  static const char *const name##_VALUES[] = {__VA_ARGS__};                    \
+  _Static_assert(count_of(name##_VALUES) == 1 << (width),                      \
+                 #name " needs one name per value");
+TCN75A_CONFIG_FIELDS(TCN75A_FIELD_VALUES)
+
+#define TCN75A_FIELD_ENTRY(name, label, flag, shift, width, ...)               \
+  {label, flag, name##_MASK, shift, name##_VALUES},
+const ConfigField config_fields[NUMBER_OF_CONFIG_FIELDS] = {
+    TCN75A_CONFIG_FIELDS(TCN75A_FIELD_ENTRY)};
+
+/**
+ * @brief Returns the number of values a config register field can take.
+ *
+ * @param field The index of the field, e.g. ADC_RESOLUTION_FIELD.
+ *
+ * @return The number of values, the valid ones being 0 to this minus one.
+ */
+uint8_t config_field_values(size_t field) {
+  return (config_fields[field].mask >> config_fields[field].shift) + 1;
+}
+
+/**
+ * @brief Decodes a field from a config register value.
+ *
+ * @param conf The config register value.
+ * @param field The index of the field, e.g. ADC_RESOLUTION_FIELD.
+ *
+ * @return The value of the field.
+ */
+uint8_t config_field_get(uint8_t conf, size_t field) {
+  return (conf & config_fields[field].mask) >> config_fields[field].shift;
+}
+
+/**
+ * @brief Encodes a field value in register position.
+ *
+ * @param field The index of the field, e.g. ADC_RESOLUTION_FIELD.
+ * @param value The value of the field, below config_field_values(field).
+ *
+ * @return The value shifted into the field, with out of range bits dropped.
+ */
+uint8_t config_field_encode(size_t field, uint8_t value) {
+  return (value << config_fields[field].shift) & config_fields[field].mask;
+}
+
+/**
+ * @brief Returns the name of the value a field has in a config register value.
+ *
+ * @param conf The config register value.
+ * @param field The index of the field, e.g. ADC_RESOLUTION_FIELD.
+ *
+ * @return The name of the value, e.g. "0.0625C".
+ */
+const char *config_field_name(uint8_t conf, size_t field) {
+  return config_fields[field].value_names[config_field_get(conf, field)];
+}
+
+/**
+ * @brief Reads data from a register on a temperature sensor over I2C.
+ *
+ * This function reads data from a register on a temperature sensor over I2C.
+ * The function calls the reg_read function with the specified I2C instance,
+ * device address, register address, buffer, and number of bytes to read.
+ *
+ * @param i2c A pointer to the I2C instance to use for the read.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param reg_addr The register address to read from.
+ * @param buf A pointer to the buffer to store the read data.
+ * @param nbytes The number of bytes to read from the register.
+ *
+ * @return None.
+ */
+void read_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr,
+                   uint8_t *buf, uint8_t nbytes) {
+  reg_read(i2c, dev_addr, reg_addr, buf, nbytes);
+}
+
+/**
+ * @brief Writes data to a register on a temperature sensor over I2C.
+ *
+ * This function writes data to a register on a temperature sensor over I2C. The
+ * function calls the reg_write function with the specified I2C instance, device
+ * address, register address, buffer, and number of bytes to write.
+ *
+ * @param i2c A pointer to the I2C instance to use for the write.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param reg_addr The register address to write to.
+ * @param buf A pointer to the buffer containing the data to write.
+ * @param nbytes The number of bytes to write to the register.
+ *
+ * @return None.
+ */
+void write_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr,
+                    uint8_t *buf, uint8_t nbytes) {
+  reg_write(i2c, dev_addr, reg_addr, buf, nbytes);
+}
+
+/**
+ * @brief Reads temperature data from a pair of registers on a temperature
+ * sensor over I2C.
+ *
+ * This function reads temperature data from a pair of registers on a
+ * temperature sensor over I2C. The function calls the read_temp_reg function
+ * with the specified I2C instance, device address, register address, buffer,
+ * and number of bytes to read. The function then prints a message to the
+ * console, and calls the print_temp_table function to display the temperature
+ * data in a formatted table.
+ *
+ * @param i2c A pointer to the I2C instance to use for the read.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param reg_addr The register address to read from.
+ * @param buf A pointer to the buffer to store the read data.
+ * @param nbytes The number of bytes to read from the register.
+ * @param message The message to display before the temperature table.
+ *
+ * @return None.
+ */
+void read_temperature_registers(i2c_inst_t *i2c, uint8_t dev_addr,
+                                uint8_t reg_addr, uint8_t *buf, uint8_t nbytes,
+                                const char *message) {
+  read_temp_reg(i2c, dev_addr, reg_addr, buf, nbytes);
+  printf("%s\n", message);
+  print_temp_table(buf[0], buf[1]);
+}
+
+/**
+ * @brief Reads and displays the ambient temperature from a temperature sensor
+ * over I2C.
+ *
+ * This function reads the ambient temperature from a temperature sensor over
+ * I2C by calling the read_temperature_registers function with the specified I2C
+ * instance, device address, register address, buffer, number of bytes to read,
+ * and message. The function then clears the console screen and displays the
+ * temperature data in a formatted table.
+ *
+ * @param i2c A pointer to the I2C instance to use for the read.
+ * @param dev_addr The I2C address of the temperature sensor.
+ *
+ * @return None.
+ */
+void print_ambient_temperature(i2c_inst_t *i2c, uint8_t dev_addr) {
+  uint8_t nbytes = 2;
+  uint8_t tmp[2] = {0, 0};
+  clear_screen();
+  read_temperature_registers(i2c, dev_addr, AMBIENT_TEMP_REG, tmp, nbytes,
+                             "Ambient Temperature");
+}
+
+/**
+ * @brief Displays the temperature hysteresis limit of a temperature sensor.
+ *
+ * This function displays the temperature hysteresis limit from the register
+ * shadow cache, which only touches the bus if the cached copy is missing or
+ * was invalidated by a bus recovery.
+ *
+ * @param i2c A pointer to the I2C instance the sensor is attached to.
+ * @param dev_addr The I2C address of the temperature sensor.
+ *
+ * @return None.
+ */
+void read_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr) {
+  SensorConfig sensor = {.i2c_inst = i2c, .addr = dev_addr};
+  uint16_t value;
+  if (!reg_cache_read_limit(&sensor, TEMP_HYST_MIN_REG, &value)) {
+    printf("[WARNING] Could not read the hysteresis limit\n");
+    return;
+  }
+  printf("%s\n", "Temperature Hyst Limit");
+  print_temp_table(value >> 8, value & 0xFF);
+}
+
+/**
+ * @brief Sets the temperature hysteresis limit on a temperature sensor over
+ * I2C.
+ *
+ * This function writes the specified integer and decimal parts through the
+ * register shadow cache and then displays the updated temperature hysteresis
+ * limit using the read_temp_hyst_limit function.
+ *
+ * @param i2c A pointer to the I2C instance to use for the write.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param integer_part The integer part of the temperature hysteresis limit.
+ * @param decimal_part The decimal part of the temperature hysteresis limit.
+ *
+ * @return None.
+ */
+void write_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr,
+                           uint8_t integer_part, uint8_t decimal_part) {
+  SensorConfig sensor = {.i2c_inst = i2c, .addr = dev_addr};
+  reg_cache_write_limit(&sensor, TEMP_HYST_MIN_REG,
+                        ((uint16_t)integer_part << 8) | decimal_part);
+  read_temp_hyst_limit(i2c, dev_addr);
+}
+
+/**
+ * @brief Displays the temperature set limit of a temperature sensor.
+ *
+ * This function displays the temperature set limit from the register shadow
+ * cache, which only touches the bus if the cached copy is missing or was
+ * invalidated by a bus recovery.
+ *
+ * @param i2c A pointer to the I2C instance the sensor is attached to.
+ * @param dev_addr The I2C address of the temperature sensor.
+ *
+ * @return None.
+ */
+void read_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr) {
+  SensorConfig sensor = {.i2c_inst = i2c, .addr = dev_addr};
+  uint16_t value;
+  if (!reg_cache_read_limit(&sensor, TEMP_SET_MAX_REG, &value)) {
+    printf("[WARNING] Could not read the set limit\n");
+    return;
+  }
+  printf("%s\n", "Temperature Set Limit");
+  print_temp_table(value >> 8, value & 0xFF);
+}
+
+/**
+ * @brief Sets the temperature set limit on a temperature sensor over I2C.
+ *
+ * This function writes the specified integer and decimal parts through the
+ * register shadow cache and then displays the updated temperature set limit
+ * using the read_temp_set_limit function.
+ *
+ * @param i2c A pointer to the I2C instance to use for the write.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param integer_part The integer part of the temperature set limit.
+ * @param decimal_part The decimal part of the temperature set limit.
+ *
+ * @return None.
+ */
+void write_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr,
+                          uint8_t integer_part, uint8_t decimal_part) {
+  SensorConfig sensor = {.i2c_inst = i2c, .addr = dev_addr};
+  reg_cache_write_limit(&sensor, TEMP_SET_MAX_REG,
+                        ((uint16_t)integer_part << 8) | decimal_part);
+  read_temp_set_limit(i2c, dev_addr);
+}
+
+/**
+ * @brief Reads and returns the configuration register value from a temperature
+ * sensor over I2C.
+ *
+ * This function reads the configuration register value from a temperature
+ * sensor over I2C by calling the read_temp_reg function with the specified I2C
+ * instance, device address, register address, buffer, and number of bytes to
+ * read.
+ *
+ * @param i2c A pointer to the I2C instance to use for the read.
+ * @param dev_addr The I2C address of the temperature sensor.
+ *
+ * @return The value of the configuration register.
+ */
+uint8_t read_config(i2c_inst_t *i2c, uint8_t dev_addr) {
+  uint8_t nbytes = 1;
+  uint8_t tmp[1] = {0};
+  read_temp_reg(i2c, dev_addr, SENSOR_CONFIG_REG, tmp, nbytes);
+  return tmp[0];
+}
+
+/**
+ * @brief Writes the configuration register value to a temperature sensor over
+ * I2C.
+ *
+ * This function writes the specified configuration register value to a
+ * temperature sensor over I2C by calling the write_temp_reg function with the
+ * specified I2C instance, device address, register address, buffer, and number
+ * of bytes to write.
+ *
+ * @param i2c A pointer to the I2C instance to use for the write.
+ * @param dev_addr The I2C address of the temperature sensor.
+ * @param conf The value to write to the configuration register.
+ *
+ * @return Always returns 0.
+ */
+uint8_t write_config(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t conf) {
+  uint8_t nbytes = 1;
+  uint8_t tmp[1] = {conf};
+  write_temp_reg(i2c, dev_addr, SENSOR_CONFIG_REG, tmp, nbytes);
+  return 0;
+}
+
+/**
+ * @brief Checks whether the device at a sensor's address is a TCN75A.
+ *
+ * The LM75 leaves bits 5 to 7 of its config register unimplemented, while the
+ * TCN75A keeps its ADC resolution and one-shot bits there, so any of them set
+ * means a TCN75A. At the power-on config both parts read alike, and a
+ * temperature with bits below 0.5 C set means an LM75. Only registers are
+ * read. An LM75 that cannot be told apart is taken for a TCN75A at 9 bits,
+ * which reads the same.
+ *
+ * @param sensor A pointer to the sensor to probe.
+ *
+ * @return true if the device is a TCN75A, false otherwise.
+ */
+static bool tcn75a_probe(const SensorConfig *sensor) {
+  uint8_t conf;
+  uint16_t temp;
+  if (sensor_reg_read(sensor, SENSOR_CONFIG_REG, &conf, 1) != 1 ||
+      sensor_driver_read_word(sensor, AMBIENT_TEMP_REG, &temp) != 2) {
+    return false;
+  }
+  return (conf & (ADC_RESOLUTION_MASK | ONE_SHOT_MASK)) != 0 ||
+         (temp & TCN75A_PROBE_TEMP_MASK) == 0;
+}
+
+/**
+ * @brief Returns the ADC resolution of a TCN75A from the register cache.
+ *
+ * @param sensor A pointer to the sensor.
+ *
+ * @return The resolution in bits, 9 to 12.
+ */
+static uint8_t tcn75a_resolution(const SensorConfig *sensor) {
+  // The power-on resolution is 9 bits.
+  uint8_t conf = 0;
+  reg_cache_read_config(sensor, &conf);
+  return 9 + config_field_get(conf, ADC_RESOLUTION_FIELD);
+}
+
+/**
+ * @brief Returns the typical conversion time of a TCN75A.
+ *
+ * @param bits The resolution in bits, 9 to 12.
+ *
+ * @return The conversion time in milliseconds.
+ */
+static uint32_t tcn75a_conversion_ms(uint8_t bits) {
+  return TCN75A_CONVERSION_MS(bits - 9);
+}
+
+/**
+ * @brief Writes the config register of a TCN75A, whose layout is the one of
+ * TCN75A_CONFIG_FIELDS.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param conf The config register value.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if the write failed.
+ */
+static int tcn75a_configure(const SensorConfig *sensor, uint8_t conf) {
+  uint8_t buf[1] = {conf};
+  int ret = sensor_reg_write(sensor, SENSOR_CONFIG_REG, buf, 1);
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the config register of a TCN75A.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param conf A pointer that receives the config register value.
+ *
+ * @return true if the register was read, false otherwise.
+ */
+static bool tcn75a_read_config(const SensorConfig *sensor, uint8_t *conf) {
+  return sensor_reg_read(sensor, SENSOR_CONFIG_REG, conf, 1) == 1;
+}
+
+/**
+ * @brief Reads the ambient temperature register of a TCN75A.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param raw A pointer that receives the register value.
+ *
+ * @return The number of bytes read, or a PICO_ERROR code.
+ */
+static int tcn75a_read_raw(const SensorConfig *sensor, uint16_t *raw) {
+  return sensor_driver_read_word(sensor, AMBIENT_TEMP_REG, raw);
+}
+
+/**
+ * @brief Converts a TCN75A temperature register value to 1/256 C.
+ *
+ * The register already holds the integer part in its high byte, so the value
+ * only needs to be reinterpreted as signed.
+ *
+ * @param raw The register value.
+ *
+ * @return The temperature in 1/256 C.
+ */
+static int16_t HOT_PATH_FUNC(tcn75a_convert)(uint16_t raw) {
+  return (int16_t)raw;
+}
+
+/**
+ * @brief Writes the THYST and TSET registers of a TCN75A, which keep 0.5 C
+ * steps.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param hyst The temperature below which ALERT releases, in 1/256 C.
+ * @param set The temperature above which ALERT asserts, in 1/256 C.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a write failed.
+ */
+static int tcn75a_alert_config(const SensorConfig *sensor, int16_t hyst,
+                               int16_t set) {
+  return sensor_driver_write_limits(sensor, hyst, set, TEMP_LIMIT_REG_MASK);
+}
+
+const SensorDriver tcn75a_driver = {.name = "TCN75A",
+                                    .first_addr = 0x48,
+                                    .last_addr = 0x4F,
+                                    .max_baudrate = TCN75A_BAUDRATE,
+                                    .temp_reg = AMBIENT_TEMP_REG,
+                                    .config_mask = 0xFF,
+                                    .probe = tcn75a_probe,
+                                    .resolution = tcn75a_resolution,
+                                    .conversion_ms = tcn75a_conversion_ms,
+                                    .configure = tcn75a_configure,
+                                    .read_config = tcn75a_read_config,
+                                    .read_raw = tcn75a_read_raw,
+                                    .convert = tcn75a_convert,
+                                    .alert_config = tcn75a_alert_config,
+                                    .read_alert = sensor_driver_read_limits};
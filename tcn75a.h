@@ -0,0 +1,39 @@
+#ifndef __TCN75A_H__
+#define __TCN75A_H__
+
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+
+// Struct for storing the description of one config register field
+// label the name shown in the config menu and the status table
+// menu_flag the *_SHIFT flag show_config_menu sets when the field changes
+// mask the bits of the field in the config register
+// shift the position of the lowest bit of the field
+// value_names the name of every value of the field, lowest first
+typedef struct {
+  const char *label;
+  uint32_t menu_flag;
+  uint8_t mask;
+  uint8_t shift;
+  const char *const *value_names;
+} ConfigField;
+
+// Generated from TCN75A_CONFIG_FIELDS, indexed by the *_FIELD constants.
+extern const ConfigField config_fields[];
+
+void read_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes);
+void write_temp_reg(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes);
+void read_temperature_registers(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf, uint8_t nbytes, const char *message);
+void print_ambient_temperature(i2c_inst_t *i2c, uint8_t dev_addr);
+void read_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr);
+void write_temp_hyst_limit(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t integer_part, uint8_t decimal_part);
+void read_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr);
+void write_temp_set_limit(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t integer_part, uint8_t decimal_part);
+uint8_t read_config(i2c_inst_t *i2c, uint8_t dev_addr);
+uint8_t write_config(i2c_inst_t *i2c, uint8_t dev_addr, uint8_t conf);
+uint8_t config_field_values(size_t field);
+uint8_t config_field_get(uint8_t conf, size_t field);
+uint8_t config_field_encode(size_t field, uint8_t value);
+const char *config_field_name(uint8_t conf, size_t field);
+
+#endif
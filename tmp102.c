@@ -0,0 +1,248 @@
+#include "config.h"
+#include "sensor_driver.h"
+
+// TMP102 registers.
+#define TMP102_TEMP_REG 0x00
+#define TMP102_CONFIG_REG 0x01
+#define TMP102_TLOW_REG 0x02
+#define TMP102_THIGH_REG 0x03
+
+// Config register bits that always read the same: R1:R0 read as ones and
+// bits 3:0 are reserved and read as zeros.
+#define TMP102_CONFIG_ONES 0x6000
+#define TMP102_CONFIG_ZEROS 0x000F
+// Bit 0 of the temperature register is set in 13-bit extended mode.
+#define TMP102_EXTENDED_FLAG 0x0001
+// Bits implemented by the temperature and limit registers (0.0625 C).
+#define TMP102_TEMP_MASK 0xFFF0
+#define TMP102_EXTENDED_MASK 0xFFF8
+#define TMP102_BITS 12
+// Extended mode bit of the 16-bit config register. Its high byte has the
+// layout of TCN75A_CONFIG_FIELDS, with the resolution fixed at 12 bits.
+#define TMP102_CONFIG_EM 0x0010
+// Typical conversion time.
+#define TMP102_CONVERSION_MS 26
+
+/**
+ * @brief Checks whether the device at a sensor's address is a TMP102.
+ *
+ * The TMP102 shares the LM75 register map but its config register is 16 bits
+ * wide, with read-only bits that always read the same. The LM75 family has an
+ * 8-bit config register, which repeats or reads as 0xFF when two bytes are
+ * read. Only registers are read. A TMP102 whose two config bytes happen to be
+ * equal is left to the TCN75A driver, which differs only in limit rounding.
+ *
+ * @param sensor A pointer to the sensor to probe.
+ *
+ * @return true if the device is a TMP102, false otherwise.
+ */
+static bool tmp102_probe(const SensorConfig *sensor) {
+  uint16_t conf;
+  return sensor_driver_read_word(sensor, TMP102_CONFIG_REG, &conf) == 2 &&
+         (conf >> 8) != (conf & 0xFF) &&
+         (conf & TMP102_CONFIG_ONES) == TMP102_CONFIG_ONES &&
+         (conf & TMP102_CONFIG_ZEROS) == 0;
+}
+
+/**
+ * @brief Returns the resolution of a TMP102, which is fixed.
+ *
+ * @param sensor Ignored.
+ *
+ * @return TMP102_BITS.
+ */
+static uint8_t tmp102_resolution(const SensorConfig *sensor) {
+  return TMP102_BITS;
+}
+
+/**
+ * @brief Returns the typical conversion time of a TMP102.
+ *
+ * @param bits Ignored.
+ *
+ * @return TMP102_CONVERSION_MS.
+ */
+static uint32_t tmp102_conversion_ms(uint8_t bits) {
+  return TMP102_CONVERSION_MS;
+}
+
+/**
+ * @brief Writes the high byte of the config register of a TMP102, keeping the
+ * conversion rate and extended mode bits of the low byte.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param conf The config value in the TCN75A_CONFIG_FIELDS layout.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if the read or write failed.
+ */
+static int tmp102_configure(const SensorConfig *sensor, uint8_t conf) {
+  uint16_t reg;
+  int ret = sensor_driver_read_word(sensor, TMP102_CONFIG_REG, &reg);
+  if (ret != 2) {
+    return ret < 0 ? ret : PICO_ERROR_GENERIC;
+  }
+  ret = sensor_driver_write_word(sensor, TMP102_CONFIG_REG,
+                                 ((uint16_t)conf << 8) | (reg & 0xFF));
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the high byte of the config register of a TMP102.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param conf A pointer that receives the config value in the
+ * TCN75A_CONFIG_FIELDS layout.
+ *
+ * @return true if the register was read, false otherwise.
+ */
+static bool tmp102_read_config(const SensorConfig *sensor, uint8_t *conf) {
+  uint16_t reg;
+  if (sensor_driver_read_word(sensor, TMP102_CONFIG_REG, &reg) != 2) {
+    return false;
+  }
+  *conf = reg >> 8;
+  return true;
+}
+
+/**
+ * @brief Reads the temperature register of a TMP102.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param raw A pointer that receives the register value.
+ *
+ * @return The number of bytes read, or a PICO_ERROR code.
+ */
+static int tmp102_read_raw(const SensorConfig *sensor, uint16_t *raw) {
+  return sensor_driver_read_word(sensor, TMP102_TEMP_REG, raw);
+}
+
+/**
+ * @brief Converts a TMP102 temperature register value to 1/256 C.
+ *
+ * In extended mode the register is 13 bits wide and reads up to 150 C, which
+ * saturates at the largest value a sample can hold.
+ *
+ * @param raw The register value.
+ *
+ * @return The temperature in 1/256 C.
+ */
+static int16_t HOT_PATH_FUNC(tmp102_convert)(uint16_t raw) {
+  if (!(raw & TMP102_EXTENDED_FLAG)) {
+    return (int16_t)(raw & TMP102_TEMP_MASK);
+  }
+  int32_t value = (int32_t)(int16_t)(raw & TMP102_EXTENDED_MASK) * 2;
+  return value > INT16_MAX ? INT16_MAX : (int16_t)value;
+}
+
+/**
+ * @brief Reads whether a TMP102 is in 13-bit extended mode, which changes the
+ * format of its limit registers along with the temperature register.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param is_extended A pointer that receives the extended mode bit.
+ *
+ * @return true if the config register was read, false otherwise.
+ */
+static bool read_is_extended(const SensorConfig *sensor, bool *is_extended) {
+  uint16_t reg;
+  if (sensor_driver_read_word(sensor, TMP102_CONFIG_REG, &reg) != 2) {
+    return false;
+  }
+  *is_extended = reg & TMP102_CONFIG_EM;
+  return true;
+}
+
+/**
+ * @brief Encodes a temperature for a TMP102 limit register.
+ *
+ * @param value The temperature in 1/256 C.
+ * @param is_extended Whether the part is in extended mode.
+ *
+ * @return The register value.
+ */
+static uint16_t encode_limit(int16_t value, bool is_extended) {
+  if (is_extended) {
+    return (uint16_t)(value >> 1) & TMP102_EXTENDED_MASK;
+  }
+  return (uint16_t)value & TMP102_TEMP_MASK;
+}
+
+/**
+ * @brief Decodes a TMP102 limit register, which has the format of the
+ * temperature register without its extended mode flag.
+ *
+ * @param reg The register value.
+ * @param is_extended Whether the part is in extended mode.
+ *
+ * @return The temperature in 1/256 C.
+ */
+static int16_t decode_limit(uint16_t reg, bool is_extended) {
+  return tmp102_convert(is_extended ? reg | TMP102_EXTENDED_FLAG
+                                    : reg & ~TMP102_EXTENDED_FLAG);
+}
+
+/**
+ * @brief Writes the TLOW and THIGH registers of a TMP102, which keep 0.0625 C
+ * steps.
+ *
+ * @param sensor A pointer to the sensor to configure.
+ * @param hyst The temperature below which ALERT releases, in 1/256 C.
+ * @param set The temperature above which ALERT asserts, in 1/256 C.
+ *
+ * @return PICO_OK, or a PICO_ERROR code if a read or write failed.
+ */
+static int tmp102_alert_config(const SensorConfig *sensor, int16_t hyst,
+                               int16_t set) {
+  bool is_extended;
+  if (!read_is_extended(sensor, &is_extended)) {
+    return PICO_ERROR_GENERIC;
+  }
+  int ret = sensor_driver_write_word(sensor, TMP102_TLOW_REG,
+                                     encode_limit(hyst, is_extended));
+  if (ret >= 0) {
+    ret = sensor_driver_write_word(sensor, TMP102_THIGH_REG,
+                                   encode_limit(set, is_extended));
+  }
+  return ret < 0 ? ret : PICO_OK;
+}
+
+/**
+ * @brief Reads the TLOW and THIGH registers of a TMP102.
+ *
+ * @param sensor A pointer to the sensor to read.
+ * @param hyst A pointer that receives TLOW in 1/256 C.
+ * @param set A pointer that receives THIGH in 1/256 C.
+ *
+ * @return true if the registers were read, false otherwise.
+ */
+static bool tmp102_read_alert(const SensorConfig *sensor, int16_t *hyst,
+                              int16_t *set) {
+  bool is_extended;
+  uint16_t tlow;
+  uint16_t thigh;
+  if (!read_is_extended(sensor, &is_extended) ||
+      sensor_driver_read_word(sensor, TMP102_TLOW_REG, &tlow) != 2 ||
+      sensor_driver_read_word(sensor, TMP102_THIGH_REG, &thigh) != 2) {
+    return false;
+  }
+  *hyst = decode_limit(tlow, is_extended);
+  *set = decode_limit(thigh, is_extended);
+  return true;
+}
+
+const SensorDriver tmp102_driver = {.name = "TMP102",
+                                    .first_addr = 0x48,
+                                    .last_addr = 0x4B,
+                                    .max_baudrate = 400 * 1000,
+                                    .temp_reg = TMP102_TEMP_REG,
+                                    .config_mask =
+                                        (uint8_t)~ADC_RESOLUTION_MASK,
+                                    .probe = tmp102_probe,
+                                    .resolution = tmp102_resolution,
+                                    .conversion_ms = tmp102_conversion_ms,
+                                    .configure = tmp102_configure,
+                                    .read_config = tmp102_read_config,
+                                    .read_raw = tmp102_read_raw,
+                                    .convert = tmp102_convert,
+                                    .alert_config = tmp102_alert_config,
+                                    .read_alert = tmp102_read_alert};
@@ -0,0 +1,72 @@
+// Host-side decoder for the compressed sample log export.
+//
+// Build and run on the host with:
+//   cc -I.. -o sample_decode sample_decode.c ../sample_codec.c
+//   ./sample_decode < export.txt > samples.csv
+//
+// The input is the console output of "Export all samples compressed"; lines
+// that are not part of the export are ignored.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sample_codec.h"
+
+#define MAX_SENSORS 16
+#define MAX_LINE 512
+
+// Struct for passing the stream position to the sample sink
+// boot the boot count of the current samples
+// sensor the sensor index of the stream
+typedef struct {
+  int boot;
+  unsigned sensor;
+} StreamContext;
+
+static void print_sample(uint32_t ts, uint16_t raw, void *ctx) {
+  const StreamContext *stream = ctx;
+  printf("%d,%u,%lu,%.4f\n", stream->boot, stream->sensor, (unsigned long)ts,
+         (int16_t)raw / 256.0f);
+}
+
+int main(void) {
+  SampleDecoder decoders[MAX_SENSORS];
+  char line[MAX_LINE];
+  uint8_t bytes[MAX_LINE / 2];
+  int boot = 0;
+
+  for (int s = 0; s < MAX_SENSORS; s++) {
+    sample_decoder_init(&decoders[s]);
+  }
+  printf("boot,sensor,timestamp_ms,temp_c\n");
+  while (fgets(line, sizeof(line), stdin)) {
+    unsigned sensor;
+    int offset;
+    if (sscanf(line, "#boot %d", &boot) == 1) {
+      continue;
+    }
+    if (sscanf(line, "%u:%n", &sensor, &offset) != 1 ||
+        sensor >= MAX_SENSORS) {
+      continue;
+    }
+
+    size_t len = 0;
+    for (const char *p = line + offset; p[0] && p[1] && p[0] != '\n';
+         p += 2) {
+      unsigned byte;
+      if (sscanf(p, "%2x", &byte) != 1) {
+        break;
+      }
+      bytes[len++] = (uint8_t)byte;
+    }
+
+    StreamContext stream = {.boot = boot, .sensor = sensor};
+    if (sample_decode(&decoders[sensor], bytes, len, print_sample, &stream) !=
+        len) {
+      fprintf(stderr, "malformed stream for sensor %u: %s", sensor, line);
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
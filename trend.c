@@ -0,0 +1,143 @@
+#include "trend.h"
+
+#include <stdio.h>
+
+#include "event_queue.h"
+
+#define TREND_WINDOW (1u << TREND_WINDOW_SHIFT)
+#define TREND_MAX_RATE (INT32_MAX / 2)
+
+static TrendDetector trends[NUMBER_OF_SENSORS];
+
+/**
+ * @brief Sets every sensor to the default rate threshold.
+ *
+ * @return None.
+ */
+void trend_init() {
+  for (uint8_t i = 0; i < NUMBER_OF_SENSORS; i++) {
+    trend_set_threshold(i, TREND_DEFAULT_C_PER_MIN * 256);
+  }
+}
+
+/**
+ * @brief Sets the rate threshold of a sensor and restarts its detector.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param threshold The rate of change that raises an event, in 1/256 C per
+ * minute, or 0 to disable the detector.
+ *
+ * @return true if the threshold was set, false if the arguments are invalid.
+ */
+bool trend_set_threshold(uint8_t sensor, int32_t threshold) {
+  if (sensor >= NUMBER_OF_SENSORS || threshold < 0) {
+    return false;
+  }
+  TrendDetector *t = &trends[sensor];
+  t->threshold = threshold;
+  t->slope = 0;
+  t->count = 0;
+  t->direction = 0;
+  return true;
+}
+
+/**
+ * @brief Updates the slope of a sensor with one sample and raises an event
+ * when it crosses the threshold.
+ *
+ * The slope is an exponential moving average of the rate between successive
+ * samples, with a time constant of TREND_WINDOW samples. Since the sum of
+ * the rates telescopes, this weighs the net change over the window while
+ * keeping only the previous sample and the average, so the update is O(1)
+ * in time and memory. An event is raised once per crossing; the detector
+ * rearms when the slope falls back below half the threshold.
+ *
+ * @param sensor The proj_sensors index of the sensor.
+ * @param value The register value.
+ * @param timestamp_ms The time of the sample.
+ *
+ * @return None.
+ */
+static void trend_update(uint sensor, int16_t value, uint32_t timestamp_ms) {
+  TrendDetector *t = &trends[sensor];
+  uint32_t dt_ms = timestamp_ms - t->prev_ms;
+  int32_t delta = value - t->prev_value;
+  t->prev_value = value;
+  t->prev_ms = timestamp_ms;
+
+  if (t->count == 0) {
+    t->count = 1;
+    return;
+  }
+  if (dt_ms == 0) {
+    return;
+  }
+  // Rate in 1/65536 C per minute, clamped so that a large step over a short
+  // interval cannot overflow the average.
+  int64_t rate = (int64_t)delta * 60000 * 256 / dt_ms;
+  if (rate > TREND_MAX_RATE) {
+    rate = TREND_MAX_RATE;
+  } else if (rate < -TREND_MAX_RATE) {
+    rate = -TREND_MAX_RATE;
+  }
+  t->slope += ((int32_t)rate - t->slope) >> TREND_WINDOW_SHIFT;
+  if (t->count < TREND_WINDOW) {
+    t->count++;
+    return;
+  }
+  if (t->threshold == 0) {
+    return;
+  }
+
+  int32_t slope = t->slope / 256;
+  if (t->direction == 0 && (slope >= t->threshold || slope <= -t->threshold)) {
+    t->direction = slope > 0 ? 1 : -1;
+    event_push(t->direction > 0 ? EVENT_TREND_RISING : EVENT_TREND_FALLING,
+               sensor, timestamp_ms,
+               (int16_t)(slope > INT16_MAX   ? INT16_MAX
+                         : slope < -INT16_MAX ? -INT16_MAX
+                                              : slope));
+  } else if (t->direction != 0 && slope * t->direction < t->threshold / 2) {
+    t->direction = 0;
+  }
+}
+
+/**
+ * @brief Updates the trend detector of every sensor with a new sample.
+ *
+ * It must be called from the sampling core only.
+ *
+ * @param samples The latest sample of every sensor.
+ * @param len The number of samples.
+ * @param valid_mask The bit mask of samples that hold a new reading.
+ *
+ * @return None.
+ */
+void trend_evaluate(const SensorSample *samples, size_t len,
+                    uint32_t valid_mask) {
+  for (uint i = 0; i < len && i < NUMBER_OF_SENSORS; i++) {
+    if (valid_mask & (1u << i)) {
+      trend_update(i, samples[i].filtered,
+                   to_ms_since_boot(samples[i].timestamp));
+    }
+  }
+}
+
+/**
+ * @brief Prints the smoothed rate of change and threshold of every sensor.
+ *
+ * @return None.
+ */
+void print_trends() {
+  for (int i = 0; i < NUMBER_OF_SENSORS; i++) {
+    const TrendDetector *t = &trends[i];
+    printf("Sensor %d trend: %+.3f C/min", i, t->slope / 65536.0f);
+    if (t->threshold == 0) {
+      printf(" (disabled)\n");
+    } else if (t->count < TREND_WINDOW) {
+      printf(" (warming up, %u/%u samples)\n", t->count, TREND_WINDOW);
+    } else {
+      printf(" (threshold %.2f C/min)\n", t->threshold / 256.0f);
+    }
+  }
+}
@@ -0,0 +1,31 @@
+#ifndef __TREND_H__
+#define __TREND_H__
+
+#include "config.h"
+#include "pico/stdlib.h"
+#include "sensor_poll.h"
+
+// Struct for storing the trend detector of one sensor
+// threshold the rate of change that raises an event, in 1/256 C per minute;
+// 0 disables the detector
+// slope the smoothed rate of change, in 1/65536 C per minute
+// prev_value the previous register value
+// prev_ms the time of the previous sample
+// count the number of samples seen, saturating at the window length
+// direction the sign of the trend that raised the last event, 0 if none
+typedef struct {
+  int32_t threshold;
+  int32_t slope;
+  int16_t prev_value;
+  uint32_t prev_ms;
+  uint16_t count;
+  int8_t direction;
+} TrendDetector;
+
+void trend_init();
+bool trend_set_threshold(uint8_t sensor, int32_t threshold);
+void trend_evaluate(const SensorSample *samples, size_t len,
+                    uint32_t valid_mask);
+void print_trends();
+
+#endif
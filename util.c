@@ -184,3 +184,57 @@ bool str_to_fixed_point(char *input, int32_t *output) {
     return false;
   }
 }
+
+/**
+ * @brief Converts a string representing a signed decimal number with at most
+ * two decimal places to hundredths.
+ *
+ * The accepted format is an optional '-' or '+', at least one integer digit
+ * and an optional '.' followed by one or two digits, e.g. "-5", "25.5" or
+ * "25.25".
+ *
+ * @param input The input string to convert.
+ * @param hundredths A pointer that receives the value in hundredths, e.g.
+ * -525 for "-5.25".
+ *
+ * @return true if the input is a valid number no larger than 9999999.99 in
+ * magnitude, false otherwise.
+ */
+bool str_to_hundredths(const char *input, int32_t *hundredths) {
+  bool is_negative = input[0] == '-';
+  int32_t value = 0;
+  int digits = 0;
+  int decimals = 0;
+
+  if (input[0] == '-' || input[0] == '+') {
+    input++;
+  }
+  for (; *input >= '0' && *input <= '9'; input++, digits++) {
+    if (digits == 7) {
+      return false;
+    }
+    value = value * 10 + (*input - '0');
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (*input == '.') {
+    for (input++; *input >= '0' && *input <= '9'; input++, decimals++) {
+      if (decimals == 2) {
+        return false;
+      }
+      value = value * 10 + (*input - '0');
+    }
+    if (decimals == 0) {
+      return false;
+    }
+  }
+  if (*input != '\0') {
+    return false;
+  }
+  for (; decimals < 2; decimals++) {
+    value *= 10;
+  }
+  *hundredths = is_negative ? -value : value;
+  return true;
+}
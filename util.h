@@ -7,4 +7,5 @@ void clear_screen();
 float c2f(float celsius);
 void get_input(char *input, int max_length);
 bool str_to_fixed_point(char *input, int32_t *output);
+bool str_to_hundredths(const char *input, int32_t *hundredths);
 #endif